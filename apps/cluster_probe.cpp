@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "m2c/config.h"
+#include "m2c/io_las.h"
+#include "m2c/io_pose.h"
+#include "m2c/pipeline.h"
+#include "m2c/voxel_grid.h"
+
+namespace {
+
+void printUsage(const char* prog) {
+  std::cout << "Usage: " << prog
+            << " --in <point_cloud.{las|ply|pcd}> --pose <pose.json>"
+            << " [--eps <meters>] [--voxel <meters>] [--n <float>] [--m <int>] [--refine]" << std::endl;
+}
+
+struct Args {
+  std::string cloud_path;
+  std::string pose_path;
+  float eps = 0.35f;
+  float voxel = 0.05f;
+  float n = 0.25f;
+  int m = 100;
+  bool refine = false;
+};
+
+Args parseArgs(int argc, char** argv) {
+  Args args;
+  for (int i = 1; i < argc; ++i) {
+    const std::string current(argv[i]);
+    if (current == "--help" || current == "-h") {
+      printUsage(argv[0]);
+      std::exit(0);
+    }
+    if (current == "--refine") {
+      args.refine = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      throw std::runtime_error("Missing value for " + current);
+    }
+    const std::string value(argv[++i]);
+    if (current == "--in") {
+      args.cloud_path = value;
+    } else if (current == "--pose") {
+      args.pose_path = value;
+    } else if (current == "--eps") {
+      args.eps = std::stof(value);
+    } else if (current == "--voxel") {
+      args.voxel = std::stof(value);
+    } else if (current == "--n") {
+      args.n = std::stof(value);
+    } else if (current == "--m") {
+      args.m = std::stoi(value);
+    } else {
+      throw std::runtime_error("Unknown argument: " + current);
+    }
+  }
+  if (args.cloud_path.empty() || args.pose_path.empty()) {
+    throw std::runtime_error("Both --in and --pose must be provided");
+  }
+  if (args.eps <= 0.0f) {
+    throw std::runtime_error("--eps must be positive");
+  }
+  return args;
+}
+
+// Intersection-over-union of two index sets.
+double jaccard(std::vector<int> a, std::vector<int> b) {
+  if (a.empty() && b.empty()) {
+    return 1.0;
+  }
+  std::sort(a.begin(), a.end());
+  std::sort(b.begin(), b.end());
+  std::vector<int> common;
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(common));
+  const double uni = static_cast<double>(a.size() + b.size() - common.size());
+  return static_cast<double>(common.size()) / uni;
+}
+
+double timedSelect(const m2c::CloudT& cloud, const m2c::Pose& pose, const m2c::Params& params,
+                   m2c::Result& result) {
+  const auto start = std::chrono::steady_clock::now();
+  result = m2c::selectCluster(cloud, pose, params);
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Args args;
+  try {
+    args = parseArgs(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << "Argument error: " << e.what() << std::endl;
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  try {
+    const m2c::Pose pose = m2c::loadPoseJSON(args.pose_path);
+    m2c::CloudT::Ptr cloud = m2c::loadAnyPointCloud(args.cloud_path);
+    if (args.voxel > 0.0f) {
+      m2c::CloudT::Ptr filtered = m2c::voxelFilter(cloud, args.voxel);
+      if (!filtered->empty()) {
+        cloud = filtered;
+      }
+    }
+
+    m2c::Params params = m2c::defaultParams();
+    params.eps = args.eps;
+    params.minPts_core = 8;
+    params.voxel = args.voxel;
+    params.n = args.n;
+    params.m = args.m;
+    params.refine = args.refine;
+
+    m2c::Result exact;
+    params.algo = m2c::ClusterAlgo::FEC;
+    const double fec_ms = timedSelect(*cloud, pose, params, exact);
+
+    m2c::Result preview;
+    params.algo = m2c::ClusterAlgo::VoxelCC;
+    const double voxelcc_ms = timedSelect(*cloud, pose, params, preview);
+
+    const double iou = exact.found && preview.found
+                           ? jaccard(exact.cluster.indices, preview.cluster.indices)
+                           : (exact.found == preview.found ? 1.0 : 0.0);
+
+    std::cout << "Cloud size       : " << cloud->size() << "\n";
+    // A winner that fails validation is replaced by the seeded tier's answer; say so.
+    const auto tier = [](const m2c::Result& r) {
+      return r.tier == m2c::Tier::Primary ? std::string() : std::string(" (") + m2c::tierName(r.tier) + " tier)";
+    };
+    std::cout << "FEC              : " << fec_ms << " ms, " << exact.cluster.indices.size() << " points"
+              << tier(exact) << "\n";
+    std::cout << "VoxelCC" << (args.refine ? "+refine   : " : "          : ") << voxelcc_ms << " ms, "
+              << preview.cluster.indices.size() << " points" << tier(preview) << "\n";
+    std::cout << "Agreement (IoU)  : " << iou << std::endl;
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "Cluster probe failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
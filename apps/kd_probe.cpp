@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <numeric>
 #include <random>
 #include <stdexcept>
 #include <string>
@@ -11,12 +16,24 @@
 namespace {
 
 void printUsage(const char* prog) {
-  std::cout << "Usage: " << prog << " --in <point_cloud.{las|ply|pcd}> --radius <meters>" << std::endl;
+  std::cout << "Usage: " << prog << " --in <point_cloud.{las|ply|pcd}> --radius <meters>\n"
+            << "       " << prog << " --calibrate [--radius <meters>] [--spacing <meters>] [--repeat <int>]\n"
+            << "       " << prog << " --throughput [--in <cloud> | --points <int> [--spacing <meters>]]"
+            << " [--queries <int>] [--batch <int>] [--radius <meters>] [--k <int>]" << std::endl;
 }
 
 struct Args {
   std::string cloud_path;
   float radius = 0.5f;
+  bool calibrate = false;
+  bool throughput = false;
+  bool radius_set = false;
+  float spacing = 0.05f;  // Calibration point spacing: the typical voxel leaf.
+  int repeat = 3;
+  std::size_t points = 200000;   // Throughput cloud size without --in.
+  std::size_t queries = 4000000;  // Throughput queries per workload.
+  std::size_t batch = 65536;     // Throughput queries per batched call.
+  int k = 8;
 };
 
 Args parseArgs(int argc, char** argv) {
@@ -27,21 +44,54 @@ Args parseArgs(int argc, char** argv) {
       printUsage(argv[0]);
       std::exit(0);
     }
+    if (current == "--calibrate") {
+      args.calibrate = true;
+      continue;
+    }
+    if (current == "--throughput") {
+      args.throughput = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      throw std::runtime_error("Missing value for " + current);
+    }
+    const std::string value(argv[++i]);
     if (current == "--in") {
-      if (i + 1 >= argc) {
-        throw std::runtime_error("Missing value for --in");
-      }
-      args.cloud_path = argv[++i];
+      args.cloud_path = value;
     } else if (current == "--radius") {
-      if (i + 1 >= argc) {
-        throw std::runtime_error("Missing value for --radius");
-      }
-      args.radius = std::stof(argv[++i]);
+      args.radius = std::stof(value);
+      args.radius_set = true;
+    } else if (current == "--spacing") {
+      args.spacing = std::stof(value);
+    } else if (current == "--repeat") {
+      args.repeat = std::stoi(value);
+    } else if (current == "--points") {
+      args.points = static_cast<std::size_t>(std::stoll(value));
+    } else if (current == "--queries") {
+      args.queries = static_cast<std::size_t>(std::stoll(value));
+    } else if (current == "--batch") {
+      args.batch = static_cast<std::size_t>(std::stoll(value));
+    } else if (current == "--k") {
+      args.k = std::stoi(value);
     } else {
       throw std::runtime_error("Unknown argument: " + current);
     }
   }
-  if (args.cloud_path.empty()) {
+  if (args.calibrate) {
+    if (!args.radius_set) {
+      args.radius = 2.0f * args.spacing;  // FEC eps of two voxel leaves, as in the default config.
+    }
+    if (args.spacing <= 0.0f || args.repeat < 1) {
+      throw std::runtime_error("--spacing must be positive and --repeat at least 1");
+    }
+  } else if (args.throughput) {
+    if (!args.radius_set) {
+      args.radius = 2.0f * args.spacing;
+    }
+    if (args.points == 0 || args.queries == 0 || args.batch == 0 || args.k < 1 || args.spacing <= 0.0f) {
+      throw std::runtime_error("--points, --queries, --batch, --k and --spacing must be positive");
+    }
+  } else if (args.cloud_path.empty()) {
     throw std::runtime_error("--in must be provided");
   }
   if (args.radius <= 0.0f) {
@@ -57,6 +107,233 @@ int randomIndex(std::size_t upper) {
   return static_cast<int>(dist(gen));
 }
 
+const char* backendName(m2c::SearchBackend backend) {
+  switch (backend) {
+    case m2c::SearchBackend::Auto: return "auto";
+    case m2c::SearchBackend::Tree: return "tree";
+    case m2c::SearchBackend::BruteForce: return "brute-force";
+  }
+  return "unknown";
+}
+
+// `n` points on the surface of a cube whose side keeps the mean spacing near `spacing`: the shape
+// of a voxelized masked object.
+m2c::CloudT cubeShell(std::size_t n, float spacing) {
+  const float side = spacing * std::sqrt(static_cast<float>(n) / 6.0f);
+  std::mt19937 gen(static_cast<unsigned>(n));
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::uniform_int_distribution<int> face(0, 5);
+  m2c::CloudT cloud;
+  cloud.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const int f = face(gen);
+    float c[3] = {unit(gen) * side, unit(gen) * side, unit(gen) * side};
+    c[f / 2] = (f % 2) ? side : 0.0f;
+    cloud.push_back(m2c::PointT(c[0], c[1], c[2]));
+  }
+  cloud.width = static_cast<std::uint32_t>(cloud.size());
+  cloud.height = 1;
+  return cloud;
+}
+
+// Best-of-`repeat` milliseconds for building the index and radius-querying every point once.
+double fecWorkloadMs(const m2c::CloudT& cloud, float radius, m2c::SearchBackend backend, int repeat) {
+  m2c::KDOptions options;
+  options.backend = backend;
+  std::vector<int> neighbors;
+  double best = 0.0;
+  for (int run = 0; run < repeat; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    const m2c::KD kd(cloud, options);
+    for (std::size_t i = 0; i < cloud.size(); ++i) {
+      kd.radius(static_cast<int>(i), radius, neighbors);
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (run == 0 || ms < best) best = ms;
+  }
+  return best;
+}
+
+// Sweeps cloud sizes (and, above the size crossover, query radii) and prints the KDOptions values
+// at which the brute-force scan stops beating the tree on this machine.
+int calibrate(const Args& args) {
+  const m2c::KDOptions defaults;
+  std::cout << "FEC workload: build + one radius query per point, spacing " << args.spacing << " m, best of "
+            << args.repeat << "\n\n";
+  std::cout << std::setw(8) << "points" << std::setw(10) << "radius" << std::setw(10) << "coverage" << std::setw(12)
+            << "tree ms" << std::setw(12) << "brute ms" << "\n";
+  std::cout << std::fixed << std::setprecision(3);
+
+  const auto row = [](std::size_t n, float radius, float coverage, double tree, double brute) {
+    std::cout << std::setw(8) << n << std::setw(10) << radius << std::setw(10) << coverage << std::setw(12) << tree
+              << std::setw(12) << brute << (brute <= tree ? "  brute" : "") << "\n";
+  };
+  const auto coverageOf = [](std::size_t n, float spacing, float radius) {
+    const float side = spacing * std::sqrt(static_cast<float>(n) / 6.0f);
+    return 2.0f * radius >= side ? 1.0f : std::pow(2.0f * radius / side, 3.0f);
+  };
+
+  // 1. Size crossover at the configured radius (low coverage: the tree's best case).
+  std::size_t max_points = 0;
+  bool winning = true;  // Contiguous wins only: noise past the crossover does not extend it.
+  for (std::size_t n = 256; n <= 65536; n *= 2) {
+    const m2c::CloudT cloud = cubeShell(n, args.spacing);
+    const double tree = fecWorkloadMs(cloud, args.radius, m2c::SearchBackend::Tree, args.repeat);
+    const double brute = fecWorkloadMs(cloud, args.radius, m2c::SearchBackend::BruteForce, args.repeat);
+    row(n, args.radius, coverageOf(n, args.spacing, args.radius), tree, brute);
+    winning = winning && brute <= tree;
+    if (winning) {
+      max_points = n;
+    }
+  }
+
+  // 2. Coverage crossover above it: grow the radius until brute force wins.
+  std::cout << "\n";
+  float min_coverage = 0.0f;
+  std::size_t compact_max = 0;
+  for (std::size_t n = std::max<std::size_t>(512, max_points * 2); n <= 65536; n *= 2) {
+    const m2c::CloudT cloud = cubeShell(n, args.spacing);
+    const float side = args.spacing * std::sqrt(static_cast<float>(n) / 6.0f);
+    bool won = false;
+    for (float coverage = 1.0f / 1024.0f; coverage <= 1.0f; coverage *= 4.0f) {
+      const float radius = 0.5f * side * std::cbrt(coverage);
+      const double tree = fecWorkloadMs(cloud, radius, m2c::SearchBackend::Tree, args.repeat);
+      const double brute = fecWorkloadMs(cloud, radius, m2c::SearchBackend::BruteForce, args.repeat);
+      row(n, radius, coverage, tree, brute);
+      if (brute <= tree) {
+        min_coverage = std::max(min_coverage, coverage);
+        compact_max = n;
+        won = true;
+        break;
+      }
+    }
+    if (!won) {
+      break;
+    }
+  }
+
+  // Printed as the `cluster:` keys that load them, ready to paste into the YAML config.
+  std::cout << std::defaultfloat << std::setprecision(6) << "\nMeasured crossovers, as config keys (compiled defaults in comments):\n"
+            << "cluster:\n"
+            << "  kd_brute_force_max_points: " << max_points << "  # " << defaults.brute_force_max_points << "\n"
+            << "  kd_brute_force_min_coverage: " << (compact_max ? min_coverage : 1.0f) << "  # "
+            << defaults.brute_force_min_coverage << "\n"
+            << "  kd_compact_max_points: " << compact_max << "  # " << defaults.compact_max_points << std::endl;
+  return 0;
+}
+
+// Issues `queries` radius and kNN queries, by index and by arbitrary point, through the batched
+// API in batches of `batch`, and reports the rate. The first batch of each workload is also run
+// through the single-query API on one thread, as the reference rate and to check the results.
+int throughput(const Args& args) {
+  m2c::CloudT cloud;
+  if (!args.cloud_path.empty()) {
+    cloud = *m2c::loadAnyPointCloud(args.cloud_path);
+  } else {
+    cloud = cubeShell(args.points, args.spacing);
+  }
+  if (cloud.empty()) {
+    std::cerr << "Cloud is empty, nothing to query" << std::endl;
+    return 1;
+  }
+
+  m2c::KDOptions options;
+  options.radius_hint = args.radius;
+  const auto build_start = std::chrono::steady_clock::now();
+  const m2c::KD kd(cloud, options);
+  const double build_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - build_start).count();
+
+  // Index queries walk the cloud with a stride coprime to its size; point queries are the same
+  // points moved by up to half a spacing, so they are not cloud points themselves.
+  const std::size_t n = cloud.size();
+  const std::size_t batch = std::min(args.batch, args.queries);
+  std::size_t stride = 7919;
+  while (std::gcd(stride, n) != 1) ++stride;
+  std::vector<int> indices(batch);
+  m2c::CloudT points;
+  points.resize(batch);
+  std::mt19937 gen(17);
+  std::uniform_real_distribution<float> jitter(-0.5f * args.spacing, 0.5f * args.spacing);
+  std::size_t next = 0;
+  const auto fill = [&]() {
+    for (std::size_t q = 0; q < batch; ++q) {
+      indices[q] = static_cast<int>(next);
+      const m2c::PointT& p = cloud[next];
+      points[q] = m2c::PointT(p.x + jitter(gen), p.y + jitter(gen), p.z + jitter(gen));
+      next = (next + stride) % n;
+    }
+  };
+
+  std::cout << "Cloud " << n << " points, backend " << backendName(kd.backend()) << ", build " << std::fixed
+            << std::setprecision(1) << build_ms << " ms; radius " << std::setprecision(3) << args.radius << " m, k "
+            << args.k << "; " << args.queries << " queries per workload in batches of " << batch << "\n\n";
+  std::cout << std::setw(14) << "workload" << std::setw(12) << "ms" << std::setw(12) << "Mq/s" << std::setw(12)
+            << "neighbors" << std::setw(14) << "single Mq/s" << std::setw(8) << "match" << "\n";
+
+  enum class Kind { RadiusIndex, RadiusPoint, KnnIndex, KnnPoint };
+  const struct { Kind kind; const char* name; } workloads[] = {{Kind::RadiusIndex, "radius/index"},
+                                                               {Kind::RadiusPoint, "radius/point"},
+                                                               {Kind::KnnIndex, "knn/index"},
+                                                               {Kind::KnnPoint, "knn/point"}};
+  m2c::KDBatchResult result;
+  m2c::KDScratch scratch;
+  for (const auto& workload : workloads) {
+    const auto runBatch = [&]() {
+      switch (workload.kind) {
+        case Kind::RadiusIndex: kd.radiusBatch(indices, args.radius, result); break;
+        case Kind::RadiusPoint: kd.radiusBatch(points, args.radius, result); break;
+        case Kind::KnnIndex: kd.knnBatch(indices, args.k, result); break;
+        case Kind::KnnPoint: kd.knnBatch(points, args.k, result); break;
+      }
+    };
+    const auto runSingle = [&](std::size_t q) {
+      switch (workload.kind) {
+        case Kind::RadiusIndex: kd.radius(indices[q], args.radius, scratch.indices, 0, &scratch.sqr_distances); break;
+        case Kind::RadiusPoint: kd.radius(points[q], args.radius, scratch.indices, 0, &scratch.sqr_distances); break;
+        case Kind::KnnIndex: kd.knn(indices[q], args.k, scratch.indices, &scratch.sqr_distances); break;
+        case Kind::KnnPoint: kd.knn(points[q], args.k, scratch.indices, &scratch.sqr_distances); break;
+      }
+    };
+
+    // Reference: the first batch through the single-query API, then compared with the batched run.
+    next = 0;
+    fill();
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t q = 0; q < batch; ++q) runSingle(q);
+    const double single_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    runBatch();
+    bool match = true;
+    for (std::size_t q = 0; q < batch && match; ++q) {
+      runSingle(q);
+      match = scratch.indices.size() == result.count(q) &&
+              std::equal(scratch.indices.begin(), scratch.indices.end(), result.indices.begin() + result.offsets[q]);
+    }
+
+    next = 0;
+    double batch_ms = 0.0;
+    std::size_t neighbors = 0;
+    for (std::size_t done = 0; done < args.queries; done += batch) {
+      fill();  // untimed
+      start = std::chrono::steady_clock::now();
+      runBatch();
+      batch_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      neighbors += result.indices.size();
+    }
+    const std::size_t issued = (args.queries + batch - 1) / batch * batch;
+    std::cout << std::setw(14) << workload.name << std::setw(12) << std::setprecision(1) << batch_ms << std::setw(12)
+              << std::setprecision(2) << static_cast<double>(issued) / batch_ms / 1000.0 << std::setw(12)
+              << static_cast<double>(neighbors) / static_cast<double>(issued) << std::setw(14)
+              << static_cast<double>(batch) / single_ms / 1000.0 << std::setw(8) << (match ? "yes" : "NO") << "\n";
+    if (!match) {
+      return 1;
+    }
+  }
+  std::cout << std::flush;
+  return 0;
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {
@@ -70,13 +347,22 @@ int main(int argc, char** argv) {
   }
 
   try {
+    if (args.calibrate) {
+      return calibrate(args);
+    }
+    if (args.throughput) {
+      return throughput(args);
+    }
+
     m2c::CloudT::Ptr cloud = m2c::loadAnyPointCloud(args.cloud_path);
     if (cloud->empty()) {
       std::cerr << "Cloud is empty, nothing to query" << std::endl;
       return 1;
     }
 
-    m2c::KD kd(*cloud);
+    m2c::KDOptions options;
+    options.radius_hint = args.radius;
+    m2c::KD kd(*cloud, options);
     const int seed_idx = randomIndex(cloud->size());
 
     std::vector<int> neighbors;
@@ -84,6 +370,7 @@ int main(int argc, char** argv) {
     kd.radius(seed_idx, args.radius, neighbors);
 
     std::cout << "Cloud size       : " << cloud->size() << "\n";
+    std::cout << "Backend          : " << backendName(kd.backend()) << "\n";
     std::cout << "Query index      : " << seed_idx << "\n";
     std::cout << "Radius (meters)  : " << args.radius << "\n";
     std::cout << "Neighbor count   : " << neighbors.size() << std::endl;
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <stdexcept>
@@ -10,12 +11,13 @@ namespace {
 
 void printUsage(const char* prog) {
   std::cout << "Usage: " << prog
-            << " --in <point_cloud.{las|ply|pcd}> --pose <pose.json>" << std::endl;
+            << " --in <point_cloud.{las|ply|pcd}> --pose <pose.json> [--roi <radius>]" << std::endl;
 }
 
 struct Args {
   std::string cloud_path;
   std::string pose_path;
+  float roi_radius = 0.0f;  // > 0 loads only the sphere of this radius around C.
 };
 
 Args parseArgs(int argc, char** argv) {
@@ -36,6 +38,11 @@ Args parseArgs(int argc, char** argv) {
         throw std::runtime_error("Missing value for --pose");
       }
       args.pose_path = argv[++i];
+    } else if (current == "--roi") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --roi");
+      }
+      args.roi_radius = std::stof(argv[++i]);
     } else {
       throw std::runtime_error("Unknown argument: " + current);
     }
@@ -62,10 +69,15 @@ int main(int argc, char** argv) {
 
   try {
     const m2c::Pose pose = m2c::loadPoseJSON(args.pose_path);
-    m2c::CloudT::Ptr cloud = m2c::loadAnyPointCloud(args.cloud_path);
+    const m2c::Roi roi{pose.C, args.roi_radius};
+    const auto start = std::chrono::steady_clock::now();
+    m2c::CloudT::Ptr cloud = m2c::loadAnyPointCloud(args.cloud_path, args.roi_radius > 0.0f ? &roi : nullptr);
+    const double load_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 
     std::cout << "Loaded point cloud: " << args.cloud_path << "\n";
     std::cout << "Point count    : " << cloud->size() << "\n";
+    std::cout << "Load time      : " << load_ms << " ms\n";
     std::cout << "Reference C    : [" << pose.C.x() << ", " << pose.C.y() << ", " << pose.C.z()
               << "]\n";
     return 0;
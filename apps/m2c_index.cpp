@@ -0,0 +1,79 @@
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "m2c/las_index.h"
+
+namespace {
+
+void printUsage(const char* prog) {
+  std::cout << "Usage: " << prog << " <point_cloud.las> [--cell <meters>] [--points-per-cell <int>]\n"
+            << "Reorders the LAS point records into spatially coherent cells (in place) and writes the\n"
+            << "<point_cloud.las>.m2ci sidecar used by ROI loads." << std::endl;
+}
+
+struct Args {
+  std::string las_path;
+  m2c::LasIndexOptions options;
+};
+
+Args parseArgs(int argc, char** argv) {
+  Args args;
+  for (int i = 1; i < argc; ++i) {
+    const std::string current(argv[i]);
+    if (current == "--help" || current == "-h") {
+      printUsage(argv[0]);
+      std::exit(0);
+    }
+    if (current == "--cell") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --cell");
+      }
+      args.options.cell = std::stof(argv[++i]);
+    } else if (current == "--points-per-cell") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --points-per-cell");
+      }
+      args.options.points_per_cell = static_cast<std::size_t>(std::stoull(argv[++i]));
+    } else if (!current.empty() && current[0] == '-') {
+      throw std::runtime_error("Unknown argument: " + current);
+    } else if (args.las_path.empty()) {
+      args.las_path = current;
+    } else {
+      throw std::runtime_error("Only one input file is supported");
+    }
+  }
+
+  if (args.las_path.empty()) {
+    throw std::runtime_error("An input LAS file must be provided");
+  }
+  return args;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Args args;
+  try {
+    args = parseArgs(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << "Argument error: " << e.what() << std::endl;
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  try {
+    const m2c::LasIndexSummary summary = m2c::buildLasIndex(args.las_path, args.options);
+    std::cout << "Indexed " << args.las_path << "\n";
+    std::cout << "Points         : " << summary.points << "\n";
+    std::cout << "Cell size      : " << summary.cell << " m\n";
+    std::cout << "Grid           : " << summary.nx << " x " << summary.ny << " (" << summary.occupied
+              << " occupied)\n";
+    std::cout << "Sidecar        : " << m2c::lasIndexPath(args.las_path) << std::endl;
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "Indexing failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
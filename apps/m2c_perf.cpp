@@ -0,0 +1,637 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <nlohmann/json.hpp>
+
+#include "m2c/async_load.h"
+#include "m2c/config.h"
+#include "m2c/io_las.h"
+#include "m2c/io_ply.h"
+#include "m2c/io_pose.h"
+#include "m2c/pipeline.h"
+#include "m2c/scan_grid.h"
+
+#ifndef M2C_BUILD_TYPE
+#define M2C_BUILD_TYPE ""  // CMAKE_BUILD_TYPE, set by the build
+#endif
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Exit status when at least one metric falls outside its baseline tolerance (1 is any other error).
+constexpr int kRegressionExit = 3;
+
+void printUsage(const char* prog) {
+  std::cout << "Usage: " << prog
+            << " (--corpus <dir> | --synthetic <count> [--points <int>] [--work-dir <dir>])"
+            << " [--config <path.yaml>] [--repeat <int>] [--warmup <int>]"
+            << " [--baseline <baseline.json>] [--out <results.json>]" << std::endl;
+}
+
+struct Args {
+  std::string corpus_dir;
+  int synthetic = 0;           // number of generated cases (0 with --corpus)
+  int points = 200000;         // points in the smallest synthetic case
+  std::string work_dir;        // where synthetic cases are written (temporary when empty)
+  std::string config_path;     // base YAML applied before each case's own YAML
+  int repeat = 5;
+  int warmup = 1;
+  std::string baseline_path;
+  std::string out_path;
+};
+
+Args parseArgs(int argc, char** argv) {
+  Args args;
+  for (int i = 1; i < argc; ++i) {
+    const std::string current(argv[i]);
+    if (current == "--help" || current == "-h") {
+      printUsage(argv[0]);
+      std::exit(0);
+    }
+    if (i + 1 >= argc) {
+      throw std::runtime_error("Missing value for " + current);
+    }
+    const std::string value(argv[++i]);
+    if (current == "--corpus") {
+      args.corpus_dir = value;
+    } else if (current == "--synthetic") {
+      args.synthetic = std::stoi(value);
+    } else if (current == "--points") {
+      args.points = std::stoi(value);
+    } else if (current == "--work-dir") {
+      args.work_dir = value;
+    } else if (current == "--config") {
+      args.config_path = value;
+    } else if (current == "--repeat") {
+      args.repeat = std::stoi(value);
+    } else if (current == "--warmup") {
+      args.warmup = std::stoi(value);
+    } else if (current == "--baseline") {
+      args.baseline_path = value;
+    } else if (current == "--out") {
+      args.out_path = value;
+    } else {
+      throw std::runtime_error("Unknown argument: " + current);
+    }
+  }
+  if (args.corpus_dir.empty() == (args.synthetic <= 0)) {
+    throw std::runtime_error("Provide exactly one of --corpus or --synthetic");
+  }
+  if (args.repeat <= 0 || args.warmup < 0 || args.points <= 0) {
+    throw std::runtime_error("--repeat and --points must be positive, --warmup non-negative");
+  }
+  return args;
+}
+
+struct Case {
+  std::string name;
+  std::string cloud_path;
+  std::string pose_path;
+  std::string yaml_path;  // empty when the case uses the base parameters
+};
+
+// <name>.{las,laz,ply,pcd} with a <name>.json pose next to it, plus an optional <name>.yaml.
+std::vector<Case> scanCorpus(const std::string& dir) {
+  std::vector<Case> cases;
+  for (const fs::directory_entry& entry : fs::directory_iterator(dir)) {
+    const fs::path path = entry.path();
+    const std::string ext = path.extension().string();
+    if (ext != ".las" && ext != ".laz" && ext != ".ply" && ext != ".pcd") {
+      continue;
+    }
+    fs::path pose = path;
+    pose.replace_extension(".json");
+    if (!fs::exists(pose)) {
+      continue;
+    }
+    fs::path yaml = path;
+    yaml.replace_extension(".yaml");
+    cases.push_back({path.stem().string(), path.string(), pose.string(), fs::exists(yaml) ? yaml.string() : ""});
+  }
+  std::sort(cases.begin(), cases.end(), [](const Case& a, const Case& b) { return a.name < b.name; });
+  return cases;
+}
+
+// Portable generator so a seed gives the same scene with every standard library.
+struct SceneRng {
+  std::uint64_t state;
+
+  std::uint64_t next() {
+    state += 0x9E3779B97F4A7C15ull;
+    std::uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+  double uniform(double lo, double hi) { return lo + (hi - lo) * static_cast<double>(next() >> 11) * 0x1.0p-53; }
+  double normal() {
+    const double u = uniform(1e-12, 1.0);
+    const double v = uniform(0.0, 1.0);
+    return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * v);
+  }
+};
+
+// Deterministic masked-scene stand-in: 48 compact blobs (AABB diagonal under the default
+// maxDiameter) on a jittered 8x6 grid with 2.5 m spacing, plus 20% uniform clutter. C sits
+// 0.6 m beside one blob. Cases cycle through fec, voxelcc and fec with eps auto.
+Case writeSyntheticCase(const fs::path& dir, int index, int base_points) {
+  constexpr int kCols = 8;
+  constexpr int kRows = 6;
+  constexpr double kSpacing = 2.5;
+  SceneRng rng{1000u + static_cast<std::uint64_t>(index)};
+  const std::size_t total = static_cast<std::size_t>(base_points) * static_cast<std::size_t>(1 + index % 3);
+
+  struct Blob {
+    double c[3];
+    double sigma[3];
+    double weight;
+  };
+  std::vector<Blob> blobs;
+  double weight_sum = 0.0;
+  for (int r = 0; r < kRows; ++r) {
+    for (int c = 0; c < kCols; ++c) {
+      Blob blob;
+      blob.c[0] = c * kSpacing + rng.uniform(-0.5, 0.5);
+      blob.c[1] = r * kSpacing + rng.uniform(-0.5, 0.5);
+      blob.c[2] = rng.uniform(0.6, 1.4);
+      for (double& s : blob.sigma) s = rng.uniform(0.08, 0.14);
+      blob.weight = rng.uniform(0.5, 1.5);
+      weight_sum += blob.weight;
+      blobs.push_back(blob);
+    }
+  }
+
+  m2c::CloudT cloud;
+  cloud.reserve(total);
+  const std::size_t object_points = total * 4 / 5;
+  for (const Blob& blob : blobs) {
+    const std::size_t count = static_cast<std::size_t>(static_cast<double>(object_points) * blob.weight / weight_sum);
+    for (std::size_t k = 0; k < count; ++k) {
+      float p[3];
+      for (int axis = 0; axis < 3; ++axis) {
+        const double d = std::clamp(rng.normal() * blob.sigma[axis], -0.4, 0.4);
+        p[axis] = static_cast<float>(blob.c[axis] + d);
+      }
+      cloud.push_back(m2c::PointT(p[0], p[1], p[2]));
+    }
+  }
+  while (cloud.size() < total) {
+    cloud.push_back(m2c::PointT(static_cast<float>(rng.uniform(-2.0, (kCols - 1) * kSpacing + 2.0)),
+                                static_cast<float>(rng.uniform(-2.0, (kRows - 1) * kSpacing + 2.0)),
+                                static_cast<float>(rng.uniform(0.0, 3.0))));
+  }
+
+  std::ostringstream name;
+  name << "synthetic-" << std::setw(2) << std::setfill('0') << index;
+  Case result{name.str(), (dir / (name.str() + ".ply")).string(), (dir / (name.str() + ".json")).string(),
+              (dir / (name.str() + ".yaml")).string()};
+
+  std::vector<int> all(cloud.size());
+  for (std::size_t i = 0; i < all.size(); ++i) all[i] = static_cast<int>(i);
+  m2c::writePlyBinary(result.cloud_path, cloud, all);
+
+  const Blob& target = blobs[static_cast<std::size_t>(index * 7) % blobs.size()];
+  std::ofstream pose(result.pose_path);
+  pose << std::setprecision(9) << "{\n  \"translation\": {\"x\": " << target.c[0] + 0.6 << ", \"y\": " << target.c[1]
+       << ", \"z\": " << target.c[2] << "}\n}\n";
+
+  static const char* const kAlgo[] = {"  algo: fec\n  eps: 0.1\n", "  algo: voxelcc\n  eps: 0.1\n",
+                                      "  algo: fec\n  eps: auto\n"};
+  std::ofstream yaml(result.yaml_path);
+  yaml << "cluster:\n" << kAlgo[index % 3];
+  if (!pose || !yaml) {
+    throw std::runtime_error("Failed to write synthetic case " + result.name + " under " + dir.string());
+  }
+  return result;
+}
+
+// Returns freed heap pages to the kernel. The loader runs on its own thread, hence its own glibc
+// arena, so without this a repeat's load would stack on the pages the previous repeat freed.
+void releaseFreedHeap() {
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif
+}
+
+// Starts a fresh peak-RSS window: returns freed heap to the kernel and resets VmHWM to the
+// current RSS (Linux >= 4.0). Returns false when the reset is unavailable.
+bool resetPeakRss() {
+  releaseFreedHeap();
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+  clear_refs.flush();
+  return static_cast<bool>(clear_refs);
+}
+
+double peakRssMb() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      return std::strtod(line.c_str() + 6, nullptr) / 1024.0;
+    }
+  }
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<double>(usage.ru_maxrss) / 1024.0;  // kilobytes on Linux
+}
+
+double percentile(std::vector<double> samples, double q) {
+  std::sort(samples.begin(), samples.end());
+  const std::size_t rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(samples.size())));
+  return samples[std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+double msSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+using Metrics = std::map<std::string, double>;
+
+// Same stages as the mask2cluster CLI: asynchronous load streamed straight into the voxelizer, so
+// the raw cloud is never built, then selectCluster. Export is left out. Cases run one at a time
+// (no prefetch) so each one's latency and peak RSS are its own.
+Metrics runCase(const Case& c, const m2c::Params& base, int repeat, int warmup, bool& rss_window) {
+  m2c::Params params = base;
+  if (!c.yaml_path.empty()) {
+    m2c::applyYamlConfig(c.yaml_path, params);
+  }
+  const m2c::Pose pose = m2c::loadPoseJSON(c.pose_path);
+  m2c::LoadOptions load;
+  load.voxel = params.voxel;
+  load.attributes = params.organized;  // XYZ only, like the stored baselines, unless the grid needs scan order.
+  load.scan_order = params.organized;
+  load.keep_input = false;
+  load.trim_heap = true;  // as mask2cluster does, so RSS is measured on the CLI's path
+  if (params.frustum) {
+    load.frustum.emplace(pose, params);  // a case's YAML may turn the camera-frustum prefilter on
+  }
+
+  rss_window = resetPeakRss();
+  std::vector<double> total_ms, load_ms, select_ms;
+  std::size_t points = 0;
+  m2c::Result result;
+  for (int run = 0; run < warmup + repeat; ++run) {
+    releaseFreedHeap();
+    const auto start = std::chrono::steady_clock::now();
+    m2c::LoadedCloud loaded = m2c::loadAnyPointCloudAsync(c.cloud_path, load).get();
+    const double t_load = msSince(start);
+    const m2c::CloudT::Ptr working = loaded.voxelized ? loaded.voxelized : loaded.cloud;
+    // An organized case (YAML `organized: true`, voxel 0) times the grid build as part of selection.
+    const m2c::ScanGrid scan_grid =
+        params.organized ? m2c::ScanGrid(*working, loaded.attributes) : m2c::ScanGrid();
+    result = m2c::selectCluster(*working, pose, params, scan_grid.valid() ? &scan_grid : nullptr);
+    const double t_total = msSince(start);
+    points = loaded.input_points;
+    if (run < warmup) {
+      continue;
+    }
+    total_ms.push_back(t_total);
+    load_ms.push_back(t_load);
+    select_ms.push_back(t_total - t_load);
+  }
+
+  Metrics metrics;
+  metrics["points"] = static_cast<double>(points);
+  metrics["latency_p50_ms"] = percentile(total_ms, 0.50);
+  metrics["latency_p90_ms"] = percentile(total_ms, 0.90);
+  metrics["latency_p99_ms"] = percentile(total_ms, 0.99);
+  metrics["load_p50_ms"] = percentile(load_ms, 0.50);
+  metrics["select_p50_ms"] = percentile(select_ms, 0.50);
+  // Median-based so one preempted run does not move the throughput gate.
+  const double p50 = metrics["latency_p50_ms"];
+  metrics["throughput_pts_per_s"] = p50 > 0.0 ? static_cast<double>(points) * 1000.0 / p50 : 0.0;
+  metrics["peak_rss_mb"] = peakRssMb();
+  metrics["found"] = result.found ? 1.0 : 0.0;
+  metrics["cluster_size"] = result.found ? static_cast<double>(result.cluster.indices.size()) : 0.0;
+  metrics["cluster_diameter"] = result.found ? static_cast<double>(result.cluster.diameter) : 0.0;
+  return metrics;
+}
+
+// How a metric may move before it counts as a regression.
+enum class Direction {
+  Lower,  // larger values are worse (latency, memory)
+  Higher, // smaller values are worse (throughput)
+  Exact,  // any change beyond the tolerance is a regression (selection output, corpus size)
+};
+
+struct Tolerance {
+  double rel = 0.0;  // fraction of the baseline value
+  double abs = 0.0;  // fixed allowance on top, in the metric's unit
+};
+
+struct MetricSpec {
+  const char* name;
+  Direction direction;
+  bool gated;         // checked unless the baseline says otherwise
+  Tolerance fallback; // used when the baseline omits the metric
+};
+
+// Report order; the *_p50_ms stage times are informational unless a baseline sets a tolerance.
+// load_p50_ms includes voxelization, which runs while the file is decoded.
+const MetricSpec kMetrics[] = {
+    {"points", Direction::Exact, true, {0.0, 0.0}},
+    {"latency_p50_ms", Direction::Lower, true, {0.25, 2.0}},
+    {"latency_p90_ms", Direction::Lower, true, {0.35, 2.0}},
+    {"latency_p99_ms", Direction::Lower, true, {0.50, 5.0}},
+    {"load_p50_ms", Direction::Lower, false, {}},
+    {"select_p50_ms", Direction::Lower, false, {}},
+    {"throughput_pts_per_s", Direction::Higher, true, {0.20, 0.0}},
+    {"peak_rss_mb", Direction::Lower, true, {0.20, 8.0}},
+    {"found", Direction::Exact, true, {0.0, 0.0}},
+    {"cluster_size", Direction::Exact, true, {0.0, 0.0}},
+    {"cluster_diameter", Direction::Exact, true, {1e-3, 1e-4}},
+};
+
+struct Baseline {
+  std::map<std::string, Tolerance> tolerances;  // every gated metric (file value or fallback)
+  const nlohmann::json* cases = nullptr;
+  int case_count = 0;
+  // Where the numbers were taken; empty / 0 when the file predates the field.
+  std::string build;
+  std::string build_type;
+  int threads = 0;
+};
+
+// The build this binary was made with: "core" (M2C_CORE_ONLY) or "pcl".
+const char* buildName() {
+#ifdef M2C_CORE_ONLY
+  return "core";
+#else
+  return "pcl";
+#endif
+}
+
+Baseline readBaseline(const nlohmann::json& doc) {
+  Baseline baseline;
+  const bool has_tolerances = doc.contains("tolerances");
+  for (const MetricSpec& spec : kMetrics) {
+    if (has_tolerances && doc["tolerances"].contains(spec.name)) {
+      const nlohmann::json& entry = doc["tolerances"][spec.name];
+      Tolerance tol;
+      tol.rel = entry.contains("rel") ? entry["rel"].get<double>() : 0.0;
+      tol.abs = entry.contains("abs") ? entry["abs"].get<double>() : 0.0;
+      baseline.tolerances[spec.name] = tol;
+    } else if (spec.gated) {
+      baseline.tolerances[spec.name] = spec.fallback;
+    }
+  }
+  if (!doc.contains("cases")) {
+    throw std::runtime_error("Baseline has no 'cases' object");
+  }
+  baseline.cases = &doc["cases"];
+  baseline.case_count = doc.contains("case_count") ? doc["case_count"].get<int>() : 0;
+  baseline.build = doc.contains("build") ? doc["build"].get<std::string>() : std::string();
+  baseline.build_type = doc.contains("build_type") ? doc["build_type"].get<std::string>() : std::string();
+  baseline.threads = doc.contains("threads") ? doc["threads"].get<int>() : 0;
+  return baseline;
+}
+
+// Differences between the baseline's build/threads and this run, one per line; empty when the
+// timings are comparable. A baseline without one of the fields counts as a mismatch.
+std::string environmentMismatch(const Baseline& baseline, int threads) {
+  std::ostringstream out;
+  if (baseline.build != buildName()) {
+    out << "  build: baseline '" << baseline.build << "', this run '" << buildName() << "'\n";
+  }
+  if (baseline.build_type != M2C_BUILD_TYPE) {
+    out << "  build type: baseline '" << baseline.build_type << "', this run '" << M2C_BUILD_TYPE << "'\n";
+  }
+  if (baseline.threads != threads) {
+    out << "  threads: baseline " << baseline.threads << ", this run " << threads << "\n";
+  }
+  return out.str();
+}
+
+// Prints one line per out-of-tolerance metric and returns how many there were. Without
+// `timings`, only the Exact metrics (corpus size and selection output) are checked.
+int compareCase(const std::string& name, const Metrics& current, const nlohmann::json& reference,
+                const Baseline& baseline, bool timings) {
+  int regressions = 0;
+  for (const MetricSpec& spec : kMetrics) {
+    const auto tol = baseline.tolerances.find(spec.name);
+    if (tol == baseline.tolerances.end() || !reference.contains(spec.name)) {
+      continue;
+    }
+    if (!timings && spec.direction != Direction::Exact) {
+      continue;
+    }
+    const double base = reference[spec.name].get<double>();
+    const double now = current.at(spec.name);
+    const double allowance = tol->second.rel * std::abs(base) + tol->second.abs;
+    bool bad = false;
+    switch (spec.direction) {
+      case Direction::Lower: bad = now > base + allowance; break;
+      case Direction::Higher: bad = now < base - allowance; break;
+      case Direction::Exact: bad = std::abs(now - base) > allowance; break;
+    }
+    if (bad) {
+      ++regressions;
+      std::cout << "REGRESSION " << name << " " << spec.name << ": " << base << " -> " << now << " (allowed "
+                << (spec.direction == Direction::Higher ? "-" : "+") << allowance << ")" << std::endl;
+    }
+  }
+  return regressions;
+}
+
+std::string jsonString(const std::string& s) {
+  std::string out = "\"";
+  for (char ch : s) {
+    if (ch == '"' || ch == '\\') out.push_back('\\');
+    out.push_back(ch);
+  }
+  return out + "\"";
+}
+
+// Results use the baseline layout, so a reviewed results file can be committed as the next baseline.
+void writeResults(const std::string& path, const std::vector<std::pair<std::string, Metrics>>& results,
+                  const std::map<std::string, Tolerance>& tolerances, int threads) {
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("Failed to open results file: " + path);
+  }
+  out << std::setprecision(10);
+  out << "{\n  \"tool\": \"m2c_perf\",\n";
+  out << "  \"build\": " << jsonString(buildName()) << ",\n";
+  out << "  \"build_type\": " << jsonString(M2C_BUILD_TYPE) << ",\n";
+  out << "  \"threads\": " << threads << ",\n";
+  out << "  \"case_count\": " << results.size() << ",\n";
+  out << "  \"tolerances\": {";
+  bool first = true;
+  for (const MetricSpec& spec : kMetrics) {
+    const auto tol = tolerances.find(spec.name);
+    if (tol == tolerances.end()) continue;
+    out << (first ? "\n" : ",\n") << "    " << jsonString(spec.name) << ": {\"rel\": " << tol->second.rel
+        << ", \"abs\": " << tol->second.abs << "}";
+    first = false;
+  }
+  out << "\n  },\n  \"cases\": {";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    out << (i == 0 ? "\n" : ",\n") << "    " << jsonString(results[i].first) << ": {";
+    bool first_metric = true;
+    for (const MetricSpec& spec : kMetrics) {
+      out << (first_metric ? "\n" : ",\n") << "      " << jsonString(spec.name) << ": "
+          << results[i].second.at(spec.name);
+      first_metric = false;
+    }
+    out << "\n    }";
+  }
+  out << "\n  }\n}\n";
+  if (!out) {
+    throw std::runtime_error("Failed to write results file: " + path);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Args args;
+  try {
+    args = parseArgs(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << "Argument error: " << e.what() << std::endl;
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  fs::path temp_dir;
+  int exit_code = 0;
+  try {
+    m2c::Params base = m2c::defaultParams();
+    m2c::applyYamlConfig(args.config_path, base);
+
+    nlohmann::json baseline_doc;
+    Baseline baseline;
+    if (!args.baseline_path.empty()) {
+      std::ifstream input(args.baseline_path);
+      if (!input) {
+        throw std::runtime_error("Failed to open baseline: " + args.baseline_path);
+      }
+      input >> baseline_doc;
+      baseline = readBaseline(baseline_doc);
+    } else {
+      for (const MetricSpec& spec : kMetrics) {
+        if (spec.gated) baseline.tolerances[spec.name] = spec.fallback;
+      }
+    }
+
+    std::vector<Case> cases;
+    if (!args.corpus_dir.empty()) {
+      cases = scanCorpus(args.corpus_dir);
+    } else {
+      fs::path dir = args.work_dir;
+      if (dir.empty()) {
+        temp_dir = fs::temp_directory_path() / ("m2c_perf-" + std::to_string(::getpid()));
+        dir = temp_dir;
+      }
+      fs::create_directories(dir);
+      for (int i = 0; i < args.synthetic; ++i) {
+        cases.push_back(writeSyntheticCase(dir, i, args.points));
+      }
+    }
+    if (cases.empty()) {
+      throw std::runtime_error("No <name>.{las,laz,ply,pcd} + <name>.json cases in " + args.corpus_dir);
+    }
+
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    std::cout << cases.size() << " cases, " << args.repeat << " runs each (+" << args.warmup << " warmup), "
+              << threads << " threads" << std::endl;
+    // Timings from another build or thread count say nothing about a regression: gate only the
+    // selection metrics then, and say so.
+    bool timings = true;
+    if (baseline.cases) {
+      const std::string mismatch = environmentMismatch(baseline, threads);
+      if (!mismatch.empty()) {
+        timings = false;
+        std::cout << "WARNING: " << args.baseline_path << " was recorded in a different environment:\n" << mismatch
+                  << "Latency, throughput and RSS are NOT gated; only points and the selection metrics are."
+                  << std::endl;
+      }
+    }
+    std::cout << std::left << std::setw(24) << "case" << std::right << std::setw(10) << "points" << std::setw(10)
+              << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "Mpts/s"
+              << std::setw(10) << "RSS MB" << std::setw(9) << "size" << std::setw(9) << "diam" << std::endl;
+
+    std::vector<std::pair<std::string, Metrics>> results;
+    int regressions = 0;
+    int matched = 0;
+    bool rss_window = true;
+    for (const Case& c : cases) {
+      bool reset = false;
+      const Metrics metrics = runCase(c, base, args.repeat, args.warmup, reset);
+      rss_window = rss_window && reset;
+      results.emplace_back(c.name, metrics);
+      std::cout << std::left << std::setw(24) << c.name << std::right << std::fixed << std::setprecision(1)
+                << std::setw(10) << static_cast<long long>(metrics.at("points")) << std::setw(10)
+                << metrics.at("latency_p50_ms") << std::setw(10) << metrics.at("latency_p90_ms") << std::setw(10)
+                << metrics.at("latency_p99_ms") << std::setw(10) << std::setprecision(2)
+                << metrics.at("throughput_pts_per_s") / 1e6 << std::setw(10) << std::setprecision(1)
+                << metrics.at("peak_rss_mb") << std::setw(9) << static_cast<long long>(metrics.at("cluster_size"))
+                << std::setw(9) << std::setprecision(3) << metrics.at("cluster_diameter") << std::endl;
+      std::cout.unsetf(std::ios::floatfield);
+      std::cout << std::setprecision(6);
+
+      if (baseline.cases) {
+        if (!baseline.cases->contains(c.name)) {
+          std::cout << "NEW " << c.name << ": not in baseline" << std::endl;
+          continue;
+        }
+        ++matched;
+        regressions += compareCase(c.name, metrics, (*baseline.cases)[c.name], baseline, timings);
+      }
+    }
+    if (!rss_window) {
+      std::cout << "Note: /proc/self/clear_refs unavailable; peak RSS is the process-wide high-water mark." << std::endl;
+    }
+
+    if (!args.out_path.empty()) {
+      writeResults(args.out_path, results, baseline.tolerances, threads);
+    }
+    if (baseline.cases) {
+      if (matched < baseline.case_count) {
+        ++regressions;
+        std::cout << "REGRESSION " << baseline.case_count - matched << " baseline case(s) were not run" << std::endl;
+      }
+      std::cout << (regressions == 0 ? "PASS" : "FAIL") << ": " << regressions << " regression(s) against "
+                << args.baseline_path << (timings ? "" : " (selection metrics only)") << std::endl;
+      exit_code = regressions == 0 ? 0 : kRegressionExit;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    exit_code = 1;
+  }
+
+  if (!temp_dir.empty()) {
+    std::error_code ec;
+    fs::remove_all(temp_dir, ec);
+  }
+  return exit_code;
+}
@@ -1,20 +1,28 @@
-#include <cstdint>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
-#include <cctype>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <optional>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
-#include <pcl/filters/voxel_grid.h>
-#include <pcl/io/ply_io.h>
-
+#include "m2c/async_load.h"
+#include "m2c/config.h"
+#include "m2c/eps_estimate.h"
+#include "m2c/incremental.h"
 #include "m2c/io_las.h"
+#include "m2c/io_ply.h"
 #include "m2c/io_pose.h"
 #include "m2c/pipeline.h"
+#include "m2c/scan_grid.h"
+#include "m2c/tiled.h"
+#include "m2c/trace.h"
+#include "m2c/voxel_grid.h"
 
 namespace {
 
@@ -27,6 +35,7 @@ struct CLIOptions {
   std::string config_path;
 
   std::optional<float> eps;
+  bool eps_auto = false;     // --eps auto
   std::optional<int> minPts_core;
   std::optional<int> minPts_total;
   std::optional<float> maxDiameter;
@@ -35,14 +44,40 @@ struct CLIOptions {
   std::optional<float> voxel;
   std::optional<float> n;   // optional override for fraction multiplier
   std::optional<int> m;     // optional override for top-M voting
+  std::optional<m2c::ClusterAlgo> algo;
+  bool refine = false;
+  std::optional<float> deadline_ms;
+  bool frustum = false;      // cull points outside the camera view (needs the pose rotation)
+  std::optional<float> fov_h;
+  std::optional<float> fov_v;
+  std::optional<float> near_clip;
+  std::optional<float> far_clip;
+  std::optional<m2c::CameraAxes> camera_axes;
+  bool organized = false;    // neighbor queries from the LAS scan grid (needs voxel 0)
+  bool append = false;       // incremental mode: --in holds only the newly added points
+  std::string state_path;    // incremental state file (defaults to <out>.m2cs)
+  std::string all_path;      // optional PLY with every point and its cluster id
+  std::string trace_path;    // optional Chrome/Perfetto trace-event JSON
+  float roi_radius = 0.0f;   // > 0 loads only points within this radius of C
+  bool tiled = false;        // out-of-core tiled execution
+  bool xyz_only = false;     // skip intensity/classification/RGB passthrough
+  std::string batch_path;    // "<in> <pose> <out>" per line instead of --in/--pose/--out
+  std::size_t prefetch = 1;  // batch inputs loaded ahead of the one being clustered
+  m2c::TiledOptions tiling;
 };
 
 void printUsage(const char* prog) {
   std::cout << "Usage: " << prog
             << " --in <point_cloud.{las|ply|pcd}> --pose <pose.json> --out <cluster.ply>"
-            << " [--config <path.yaml>] [--eps <float>] [--minPtsCore <int>]"
+            << " [--config <path.yaml>] [--eps <float|auto>] [--minPtsCore <int>]"
             << " [--minPtsTotal <int>] [--maxDiameter <float>] [--maxPts <int>]"
-            << " [--maxTrials <int>] [--voxel <float>] [--n <float>] [--m <int>]" << std::endl;
+            << " [--maxTrials <int>] [--voxel <float>] [--n <float>] [--m <int>]"
+            << " [--algo <fec|voxelcc>] [--refine] [--deadline-ms <float>]"
+            << " [--frustum [--fov-h <deg>] [--fov-v <deg>] [--near <float>] [--far <float>]"
+            << " [--camera-axes <flu|opencv|opengl>]] [--organized]"
+            << " [--append [--state <path.m2cs>]] [--out-all <labeled.ply>] [--trace <file.json>]"
+            << " [--roi-radius <float>] [--xyz-only] [--batch <jobs.txt> [--prefetch <int>]]"
+            << " [--tiled [--tile-size <float>] [--mem-budget-mb <int>] [--work-dir <dir>]]" << std::endl;
 }
 
 float parseFloat(const std::string& value, const std::string& name) {
@@ -94,7 +129,13 @@ CLIOptions parseArgs(int argc, char** argv) {
       if (i + 1 >= argc) {
         throw std::runtime_error("Missing value for --eps");
       }
-      opts.eps = parseFloat(argv[++i], "--eps");
+      const std::string value = argv[++i];
+      opts.eps_auto = value == "auto";
+      if (opts.eps_auto) {
+        opts.eps.reset();
+      } else {
+        opts.eps = parseFloat(value, "--eps");
+      }
     } else if (current == "--minPtsCore") {
       if (i + 1 >= argc) {
         throw std::runtime_error("Missing value for --minPtsCore");
@@ -135,116 +176,130 @@ CLIOptions parseArgs(int argc, char** argv) {
         throw std::runtime_error("Missing value for --m");
       }
       opts.m = parseInt(argv[++i], "--m");
+    } else if (current == "--algo") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --algo");
+      }
+      opts.algo = m2c::parseAlgo(argv[++i]);
+    } else if (current == "--refine") {
+      opts.refine = true;
+    } else if (current == "--xyz-only") {
+      opts.xyz_only = true;
+    } else if (current == "--batch") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --batch");
+      }
+      opts.batch_path = argv[++i];
+    } else if (current == "--prefetch") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --prefetch");
+      }
+      opts.prefetch = static_cast<std::size_t>(std::max(1, parseInt(argv[++i], "--prefetch")));
+    } else if (current == "--deadline-ms") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --deadline-ms");
+      }
+      opts.deadline_ms = parseFloat(argv[++i], "--deadline-ms");
+    } else if (current == "--frustum") {
+      opts.frustum = true;
+    } else if (current == "--fov-h") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --fov-h");
+      }
+      opts.fov_h = parseFloat(argv[++i], "--fov-h");
+    } else if (current == "--fov-v") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --fov-v");
+      }
+      opts.fov_v = parseFloat(argv[++i], "--fov-v");
+    } else if (current == "--near") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --near");
+      }
+      opts.near_clip = parseFloat(argv[++i], "--near");
+    } else if (current == "--far") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --far");
+      }
+      opts.far_clip = parseFloat(argv[++i], "--far");
+    } else if (current == "--camera-axes") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --camera-axes");
+      }
+      opts.camera_axes = m2c::parseCameraAxes(argv[++i]);
+    } else if (current == "--organized") {
+      opts.organized = true;
+    } else if (current == "--append") {
+      opts.append = true;
+    } else if (current == "--state") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --state");
+      }
+      opts.state_path = argv[++i];
+    } else if (current == "--out-all") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --out-all");
+      }
+      opts.all_path = argv[++i];
+    } else if (current == "--trace") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --trace");
+      }
+      opts.trace_path = argv[++i];
+    } else if (current == "--roi-radius") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --roi-radius");
+      }
+      opts.roi_radius = parseFloat(argv[++i], "--roi-radius");
+    } else if (current == "--tiled") {
+      opts.tiled = true;
+    } else if (current == "--tile-size") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --tile-size");
+      }
+      opts.tiling.tile_size = parseFloat(argv[++i], "--tile-size");
+    } else if (current == "--mem-budget-mb") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --mem-budget-mb");
+      }
+      opts.tiling.memory_budget = static_cast<std::size_t>(parseInt(argv[++i], "--mem-budget-mb")) << 20;
+    } else if (current == "--work-dir") {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value for --work-dir");
+      }
+      opts.tiling.work_dir = argv[++i];
     } else {
       throw std::runtime_error("Unknown argument: " + current);
     }
   }
 
-  if (opts.cloud_path.empty() || opts.pose_path.empty() || opts.output_path.empty()) {
+  if (!opts.batch_path.empty()) {
+    if (!opts.cloud_path.empty() || !opts.pose_path.empty() || !opts.output_path.empty()) {
+      throw std::runtime_error("--batch takes its inputs from the job file; drop --in, --pose and --out");
+    }
+    if (opts.tiled || opts.append || !opts.all_path.empty()) {
+      throw std::runtime_error("--batch cannot be combined with --tiled, --append or --out-all");
+    }
+  } else if (opts.cloud_path.empty() || opts.pose_path.empty() || opts.output_path.empty()) {
     throw std::runtime_error("--in, --pose, and --out are required");
   }
-
-  return opts;
-}
-
-Params defaultParams() {
-  Params params{};
-  params.eps = 0.35f;
-  params.minPts_core = 8;
-  params.minPts_total = 60; // This line remains unchanged
-  params.maxDiameter = 1.5f;
-  params.maxPts = 500000;
-  params.max_trials = 100;
-  params.voxel = 0.05f;
-  params.n = 0.25f; // New parameter
-  params.m = 100;   // New parameter
-  return params;
-}
-
-std::string trimCopy(const std::string& s) {
-  const auto start = s.find_first_not_of(" \t\r\n");
-  if (start == std::string::npos) {
-    return std::string();
+  if (opts.tiled && (opts.append || !opts.all_path.empty())) {
+    throw std::runtime_error("--tiled cannot be combined with --append or --out-all");
   }
-  const auto end = s.find_last_not_of(" \t\r\n");
-  return s.substr(start, end - start + 1);
-}
-
-float parseScalar(const std::string& key, const std::string& value) {
-  try {
-    return std::stof(value);
-  } catch (const std::exception&) {
-    throw std::runtime_error("Invalid numeric value for '" + key + "': " + value);
-  }
-}
-
-void applyYamlConfig(const std::string& path, Params& params) {
-  if (path.empty()) {
-    return;
-  }
-
-  std::ifstream input(path);
-  if (!input) {
-    throw std::runtime_error("Failed to open config file: " + path);
+  if (opts.tiled && opts.roi_radius > 0.0f) {
+    throw std::runtime_error("--tiled streams the whole file; use --roi-radius without it");
   }
 
-  std::string line;
-  bool inCluster = false;
-
-  while (std::getline(input, line)) {
-    const std::string trimmed = trimCopy(line);
-    if (trimmed.empty() || trimmed[0] == '#') {
-      continue;
-    }
-
-    const bool topLevel = !line.empty() && !std::isspace(static_cast<unsigned char>(line[0]));
-    if (topLevel && trimmed.back() == ':') {
-      inCluster = trimmed == "cluster:";
-      continue;
-    }
-
-    if (!inCluster) {
-      continue;
-    }
-
-    const auto colonPos = trimmed.find(':');
-    if (colonPos == std::string::npos) {
-      continue;
-    }
-
-    std::string key = trimCopy(trimmed.substr(0, colonPos));
-    std::string value = trimCopy(trimmed.substr(colonPos + 1));
-
-    const auto commentPos = value.find('#');
-    if (commentPos != std::string::npos) {
-      value = trimCopy(value.substr(0, commentPos));
-    }
-
-    if (value.empty()) {
-      continue;
-    }
-
-    if (key == "eps") {
-      params.eps = parseScalar(key, value);
-    } else if (key == "minPts_core") {
-      params.minPts_core = static_cast<int>(parseScalar(key, value));
-    } else if (key == "minPts_total") {
-      params.minPts_total = static_cast<int>(parseScalar(key, value));
-    } else if (key == "maxDiameter") {
-      params.maxDiameter = parseScalar(key, value);
-    } else if (key == "maxPts") {
-      params.maxPts = static_cast<int>(parseScalar(key, value));
-    } else if (key == "max_trials") {
-      params.max_trials = static_cast<int>(parseScalar(key, value));
-    } else if (key == "voxel") {
-      params.voxel = parseScalar(key, value);
-    }
-  }
+  return opts;
 }
 
 void applyOverrides(const CLIOptions& opts, Params& params) {
   if (opts.eps) {
     params.eps = *opts.eps;
+    params.eps_auto = false;
+  }
+  if (opts.eps_auto) {
+    params.eps_auto = true;
   }
   if (opts.minPts_core) {
     params.minPts_core = *opts.minPts_core;
@@ -264,8 +319,55 @@ void applyOverrides(const CLIOptions& opts, Params& params) {
   if (opts.voxel) {
     params.voxel = *opts.voxel;
   }
+  if (opts.algo) {
+    params.algo = *opts.algo;
+  }
+  if (opts.refine) {
+    params.refine = true;
+  }
+  if (opts.deadline_ms) {
+    params.deadline = *opts.deadline_ms;
+  }
+  if (opts.frustum) {
+    params.frustum = true;
+  }
+  if (opts.fov_h) {
+    params.fov_h = *opts.fov_h;
+  }
+  if (opts.fov_v) {
+    params.fov_v = *opts.fov_v;
+  }
+  if (opts.near_clip) {
+    params.near_clip = *opts.near_clip;
+  }
+  if (opts.far_clip) {
+    params.far_clip = *opts.far_clip;
+  }
+  if (opts.camera_axes) {
+    params.camera_axes = *opts.camera_axes;
+  }
+  if (opts.organized) {
+    params.organized = true;
+  }
 }
 
+// Writes the recorded spans when main() returns, whichever exit path is taken.
+struct TraceFlush {
+  std::string path;
+
+  ~TraceFlush() {
+    if (path.empty() || !m2c::trace::active()) {
+      return;
+    }
+    try {
+      m2c::trace::writeChromeTrace(path);
+      std::cout << "Trace written to " << path << std::endl;
+    } catch (const std::exception& e) {
+      std::cerr << "Failed to write trace: " << e.what() << std::endl;
+    }
+  }
+};
+
 void ensureOutputDirectory(const std::string& path) {
   const std::filesystem::path outPath(path);
   const auto parent = outPath.parent_path();
@@ -278,6 +380,244 @@ void ensureOutputDirectory(const std::string& path) {
   }
 }
 
+m2c::LoadOptions loadOptions(const CLIOptions& opts, const Params& params, const m2c::Pose& pose) {
+  m2c::LoadOptions load;
+  load.roi = m2c::Roi{pose.C, opts.roi_radius};
+  // Attributes ride along in side columns; clustering only ever sees the XYZ cloud.
+  load.attributes = (!opts.xyz_only && !opts.append) || params.organized;
+  load.scan_order = params.organized;
+  load.voxel = params.voxel;
+  // Clustering only needs the centroids, so the raw cloud is never built.
+  load.keep_input = false;
+  // This process only clusters after loading: hand the loader's freed pages back to the OS.
+  load.trim_heap = true;
+  if (params.frustum) {
+    load.frustum.emplace(pose, params);
+  }
+  return load;
+}
+
+// Everything after loading: voxel fallback, selection, export. Returns the process exit code.
+int runJob(const CLIOptions& opts, Params params, const m2c::Pose& pose, m2c::LoadedCloud loaded) {
+  m2c::CloudT::Ptr working = loaded.cloud;
+  m2c::PointAttributes attributes = std::move(loaded.attributes);
+  if (params.frustum) {
+    std::cout << "Frustum kept " << loaded.input_points - loaded.culled_points << " of " << loaded.input_points
+              << " points" << std::endl;
+  }
+
+  if (loaded.voxelized) {
+    // Without the raw cloud the loader already gave each centroid the attributes of the first input
+    // point in its voxel; an empty result then means the input had no finite point to fall back on.
+    if (!loaded.cloud || !loaded.voxelized->empty()) {
+      working = loaded.voxelized;
+      if (loaded.cloud && !attributes.empty()) attributes = attributes.select(loaded.first_source);
+    } else {
+      std::cerr << "Warning: voxel downsampling produced an empty cloud; falling back to raw input." << std::endl;
+    }
+  }
+
+  // Organized input: the scan columns are only needed to build the grid.
+  m2c::ScanGrid scan_grid;
+  if (params.organized) {
+    scan_grid = m2c::ScanGrid(*working, attributes);
+    if (scan_grid.valid()) {
+      std::cout << "Scan grid: " << scan_grid.rows() << " lines x " << scan_grid.cols() << " steps, "
+                << scan_grid.placed() << " of " << working->size() << " points placed" << std::endl;
+    } else {
+      std::cout << "Input has no usable scan grid (scan angle / GPS time); using the spatial index" << std::endl;
+    }
+    std::vector<float>().swap(attributes.scan_angle);
+    std::vector<double>().swap(attributes.gps_time);
+    if (opts.xyz_only) attributes.clear();
+  }
+
+  // In append mode the selection runs over the accumulated cloud kept in the state file.
+  std::optional<m2c::IncrementalClusterer> incremental;
+  const m2c::CloudT* source = working.get();
+  m2c::Result selection;
+  if (opts.append) {
+    const std::string state_path = opts.state_path.empty() ? opts.output_path + ".m2cs" : opts.state_path;
+    if (std::filesystem::exists(state_path)) {
+      incremental.emplace(m2c::IncrementalClusterer::load(state_path));
+      if (params.eps_auto) {
+        params.eps = incremental->eps();  // the state fixes eps for every later batch
+      } else if (std::abs(incremental->eps() - params.eps) > 1e-6f) {
+        std::cerr << "State file " << state_path << " was built with eps " << incremental->eps()
+                  << "; rerun without --append to change eps." << std::endl;
+        return 1;
+      }
+    } else {
+      if (params.eps_auto) {
+        params.eps = m2c::estimateEps(*working, m2c::KD(*working), params.minPts_core).eps;
+      }
+      incremental.emplace(params.eps);
+    }
+    incremental->append(*working);
+    source = &incremental->cloud();
+    selection = m2c::selectIncremental(*incremental, pose, params);
+    if (!opts.all_path.empty()) {
+      selection.labels = incremental->labels();  // the only O(N) step, for the labeled export
+    }
+    ensureOutputDirectory(state_path);
+    incremental->save(state_path);
+    std::cout << "State " << state_path << ": " << incremental->size() << " points, "
+              << incremental->componentCount() << " components" << std::endl;
+  } else {
+    selection = m2c::selectCluster(*working, pose, params, scan_grid.valid() ? &scan_grid : nullptr);
+  }
+  if (params.eps_auto) {
+    std::cout << "Estimated eps: " << selection.eps << std::endl;
+  }
+  if (params.deadline > 0.0f || selection.tiers.size() > 1) {
+    for (const m2c::TierReport& tier : selection.tiers) {
+      std::cout << "Tier " << m2c::tierName(tier.tier) << ": " << tier.elapsed_ms << " / " << tier.budget_ms
+                << " ms" << (!tier.completed ? " (deadline exceeded)" : tier.rejected ? " (winner rejected)" : "")
+                << std::endl;
+    }
+  }
+  if (!selection.found) {
+    if (selection.rejected) {
+      std::cerr << "The voted cluster failed validation (minPtsTotal / maxDiameter)." << std::endl;
+    } else {
+      std::cerr << "No qualifying cluster found after " << selection.trials << " trials." << std::endl;
+    }
+    return 2;
+  }
+
+  if (selection.cluster.indices.empty()) {
+    std::cerr << "Internal error: cluster reported as found but has no points." << std::endl;
+    return 3;
+  }
+
+  const bool any_valid = std::any_of(selection.cluster.indices.begin(), selection.cluster.indices.end(),
+                                     [source](int idx) {
+                                       return idx >= 0 && static_cast<std::size_t>(idx) < source->size();
+                                     });
+  if (!any_valid) {
+    std::cerr << "Cluster extraction yielded no valid points." << std::endl;
+    return 3;
+  }
+
+  // Stream straight from the working cloud; no intermediate copy of the cluster is built.
+  const m2c::PointAttributes* exported = attributes.empty() ? nullptr : &attributes;
+  std::size_t written = 0;
+  try {
+    ensureOutputDirectory(opts.output_path);
+    written = m2c::writePlyBinary(opts.output_path, *source, selection.cluster.indices, exported);
+  } catch (const std::exception& e) {
+    std::cerr << "Failed to write output PLY: " << e.what() << std::endl;
+    return 4;
+  }
+  std::cout << "Cluster saved to " << opts.output_path << " (" << written << " points)" << std::endl;
+
+  if (!opts.all_path.empty()) {
+    // The seeded fallback tier yields no labeling; mark just the selected cluster as id 0.
+    std::vector<int> labels = selection.labels;
+    if (labels.size() != source->size()) {
+      labels.assign(source->size(), -1);
+      for (int idx : selection.cluster.indices) {
+        if (idx >= 0 && static_cast<std::size_t>(idx) < labels.size()) labels[idx] = 0;
+      }
+    }
+    try {
+      ensureOutputDirectory(opts.all_path);
+      m2c::writePlyLabeled(opts.all_path, *source, labels, exported);
+    } catch (const std::exception& e) {
+      std::cerr << "Failed to write labeled PLY: " << e.what() << std::endl;
+      return 4;
+    }
+    std::cout << "Labeled cloud saved to " << opts.all_path << " (" << selection.stats.size()
+              << " clusters)" << std::endl;
+  }
+  return 0;
+}
+
+// One "<in> <pose> <out>" job per line ('#' starts a comment). The next inputs are loaded while
+// the current one is clustered; a failed job is reported and the rest still run.
+int runBatch(const CLIOptions& opts, const Params& params) {
+  std::ifstream list(opts.batch_path);
+  if (!list) {
+    throw std::runtime_error("Failed to open batch file: " + opts.batch_path);
+  }
+  std::vector<CLIOptions> jobs;
+  std::vector<m2c::Pose> poses;
+  std::vector<std::string> errors;  // Per job; a job with an unusable pose is never loaded.
+  std::vector<m2c::LoadRequest> requests;
+  std::string line;
+  for (int number = 1; std::getline(list, line); ++number) {
+    const std::size_t hash = line.find('#');
+    std::istringstream fields(line.substr(0, hash));
+    CLIOptions job = opts;
+    if (!(fields >> job.cloud_path)) {
+      continue;
+    }
+    std::string extra;
+    if (!(fields >> job.pose_path >> job.output_path) || (fields >> extra)) {
+      throw std::runtime_error("Batch line " + std::to_string(number) + ": expected <in> <pose> <out>");
+    }
+    m2c::Pose pose;
+    std::string error;
+    try {
+      pose = m2c::loadPoseJSON(job.pose_path);
+      requests.push_back({job.cloud_path, loadOptions(job, params, pose)});
+    } catch (const std::exception& e) {
+      error = e.what();
+    }
+    poses.push_back(pose);
+    errors.push_back(error);
+    jobs.push_back(job);
+  }
+
+  m2c::CloudPrefetcher prefetcher(std::move(requests), opts.prefetch);
+  int first_failure = 0;
+  std::size_t succeeded = 0;
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    std::cout << "[" << i + 1 << "/" << jobs.size() << "] " << jobs[i].cloud_path << std::endl;
+    int code = 0;
+    try {
+      if (!errors[i].empty()) {
+        throw std::runtime_error(errors[i]);
+      }
+      code = runJob(jobs[i], params, poses[i], prefetcher.next());
+    } catch (const std::exception& e) {
+      std::cerr << "Job " << i + 1 << " failed: " << e.what() << std::endl;
+      code = 5;
+    }
+    if (code == 0) {
+      ++succeeded;
+    } else if (first_failure == 0) {
+      first_failure = code;
+    }
+  }
+  std::cout << succeeded << "/" << jobs.size() << " jobs succeeded" << std::endl;
+  return first_failure;
+}
+
+// Out-of-core path: the input is never materialized; only the selected cluster comes back.
+int runTiled(const CLIOptions& opts, const Params& params) {
+  const m2c::Pose pose = m2c::loadPoseJSON(opts.pose_path);
+  const m2c::TiledSelection selection = m2c::selectClusterTiled(opts.cloud_path, pose, params, opts.tiling);
+  std::cout << "Tiles: " << selection.tiles << " (" << selection.tiles_voted << " read for the vote), "
+            << selection.result.stats.size() << " components" << std::endl;
+  if (!selection.result.found || selection.points->empty()) {
+    std::cerr << (selection.result.rejected ? "The voted cluster failed validation (minPtsTotal / maxDiameter)."
+                                            : "No qualifying cluster found.")
+              << std::endl;
+    return 2;
+  }
+
+  try {
+    ensureOutputDirectory(opts.output_path);
+    m2c::writePlyBinary(opts.output_path, *selection.points, selection.result.cluster.indices);
+  } catch (const std::exception& e) {
+    std::cerr << "Failed to write output PLY: " << e.what() << std::endl;
+    return 4;
+  }
+  std::cout << "Cluster saved to " << opts.output_path << " (" << selection.points->size() << " points)" << std::endl;
+  return 0;
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {
@@ -290,7 +630,17 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  Params params = defaultParams();
+  TraceFlush trace_flush;
+  if (!opts.trace_path.empty()) {
+    if (m2c::trace::kCompiledIn) {
+      m2c::trace::start();
+      trace_flush.path = opts.trace_path;
+    } else {
+      std::cerr << "Warning: --trace ignored; rebuild with -DM2C_WITH_TRACE=ON to enable tracing." << std::endl;
+    }
+  }
+
+  Params params = m2c::defaultParams();
 
   try {
     // New overrides for n and m
@@ -300,7 +650,7 @@ int main(int argc, char** argv) {
     if (opts.m) {
       params.m = *opts.m;
     }
-    applyYamlConfig(opts.config_path, params);
+    m2c::applyYamlConfig(opts.config_path, params);
     applyOverrides(opts, params);
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
@@ -311,64 +661,27 @@ int main(int argc, char** argv) {
     std::cerr << "Configuration error: minPtsCore, minPtsTotal, maxPts, and maxTrials must be positive." << std::endl;
     return 1;
   }
+  if (params.organized && params.voxel > 0.0f) {
+    std::cerr << "Configuration error: --organized needs the full-resolution scan order; set voxel to 0." << std::endl;
+    return 1;
+  }
+  if (params.organized && (opts.tiled || opts.append)) {
+    std::cerr << "Configuration error: --organized cannot be combined with --tiled or --append." << std::endl;
+    return 1;
+  }
 
   try {
-    m2c::CloudT::Ptr cloud = m2c::loadAnyPointCloud(opts.cloud_path);
-    const m2c::Pose pose = m2c::loadPoseJSON(opts.pose_path);
-
-    m2c::CloudT::Ptr working = cloud;
-    m2c::CloudT::Ptr filtered(new m2c::CloudT);
-
-    if (params.voxel > 0.0f) {
-      pcl::VoxelGrid<m2c::PointT> voxel;
-      voxel.setInputCloud(cloud);
-      voxel.setLeafSize(params.voxel, params.voxel, params.voxel);
-      voxel.filter(*filtered);
-
-      if (!filtered->empty()) {
-        working = filtered;
-      } else {
-        std::cerr << "Warning: voxel downsampling produced an empty cloud; falling back to raw input." << std::endl;
-      }
-    }
-
-    const m2c::Result selection = m2c::selectCluster(*working, pose, params);
-    if (!selection.found) {
-      std::cerr << "No qualifying cluster found after " << selection.trials << " trials." << std::endl;
-      return 2;
+    if (opts.tiled) {
+      return runTiled(opts, params);
     }
 
-    if (selection.cluster.indices.empty()) {
-      std::cerr << "Internal error: cluster reported as found but has no points." << std::endl;
-      return 3;
+    if (!opts.batch_path.empty()) {
+      return runBatch(opts, params);
     }
 
-    m2c::CloudT output;
-    output.reserve(selection.cluster.indices.size());
-    for (int idx : selection.cluster.indices) {
-      if (idx < 0 || static_cast<std::size_t>(idx) >= working->size()) {
-        continue;
-      }
-      output.push_back((*working)[idx]);
-    }
-
-    if (output.empty()) {
-      std::cerr << "Cluster extraction yielded no valid points." << std::endl;
-      return 3;
-    }
-
-    output.width = static_cast<std::uint32_t>(output.size());
-    output.height = 1;
-    output.is_dense = false;
-
-    ensureOutputDirectory(opts.output_path);
-    if (pcl::io::savePLYFileBinary(opts.output_path, output) < 0) {
-      std::cerr << "Failed to write output PLY: " << opts.output_path << std::endl;
-      return 4;
-    }
-
-    std::cout << "Cluster saved to " << opts.output_path << " (" << output.size() << " points)" << std::endl;
-    return 0;
+    const m2c::Pose pose = m2c::loadPoseJSON(opts.pose_path);
+    // Decoding and voxelization overlap on the loader's threads even for a single input.
+    return runJob(opts, params, pose, m2c::loadAnyPointCloudAsync(opts.cloud_path, loadOptions(opts, params, pose)).get());
   } catch (const std::exception& e) {
     std::cerr << "Execution failed: " << e.what() << std::endl;
     return 5;
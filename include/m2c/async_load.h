@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "m2c/frustum.h"
+#include "m2c/point_attributes.h"
+#include "m2c/types.h"
+
+namespace m2c {
+
+struct LoadOptions {
+	Roi roi{Eigen::Vector3f::Zero(), 0.0f};     // Radius > 0 loads only this sphere (see loadAnyPointCloud).
+	bool attributes = true;                     // Fill LoadedCloud::attributes.
+	bool scan_order = false;                    // With `attributes`, add LAS scan angle and GPS time.
+	float voxel = 0.0f;                         // > 0 also voxelizes, chunk by chunk as the file is decoded.
+	std::size_t chunk_points = std::size_t(1) << 16;  // Decode granularity.
+	std::size_t read_ahead = 4;                 // Decoded chunks buffered ahead of the voxelizer.
+	// With voxel > 0, false streams the chunks into the voxelizer only: the full-resolution cloud is
+	// never built, so memory follows the occupied voxels instead of the input size.
+	bool keep_input = true;
+	std::optional<Frustum> frustum;             // Drops the points outside it from every chunk first.
+	// glibc only: malloc_trim(0) once loaded, returning the pages the load freed (voxel map, chunk
+	// buffers) to the OS before clustering. It walks every arena of the process, so it is left to
+	// callers that own the process (the CLI) rather than done on every library load.
+	bool trim_heap = false;
+};
+
+struct LoadedCloud {
+	CloudT::Ptr cloud;              // Full-resolution input; nullptr unless LoadOptions::keep_input.
+	PointAttributes attributes;     // Index-aligned with `cloud`, or with `voxelized` when no `cloud`.
+	CloudT::Ptr voxelized;          // voxelFilter(cloud, voxel) when LoadOptions::voxel > 0, else nullptr.
+	std::vector<int> first_source;  // Per voxelized point, the first input point of its voxel.
+	std::size_t input_points = 0;   // Points read, kept or not.
+	std::size_t culled_points = 0;  // Points LoadOptions::frustum removed.
+};
+
+// Decodes a point cloud on a background thread (forEachPointChunk) and hands the chunks over in
+// file order through a queue of at most `read_ahead` chunks, so the reader stalls instead of
+// running ahead of a slow consumer. Destroying the stream stops the reader at its next chunk.
+class PointChunkStream {
+ public:
+	PointChunkStream(const std::string& path,
+	                 std::size_t chunk_points,
+	                 std::size_t read_ahead,
+	                 bool attributes,
+	                 bool scan_order = false);
+	~PointChunkStream();
+
+	PointChunkStream(const PointChunkStream&) = delete;
+	PointChunkStream& operator=(const PointChunkStream&) = delete;
+
+	// Moves the next chunk into `chunk` (and its columns into `attributes`); false once the file is
+	// exhausted. Rethrows the reader's exception, if any, after the chunks read before it.
+	bool next(CloudT& chunk, PointAttributes* attributes = nullptr);
+
+ private:
+	struct State;
+	std::shared_ptr<State> state_;
+	std::thread reader_;
+};
+
+// Starts loading `path` on a background thread and returns immediately. Without an ROI the file is
+// decoded by a PointChunkStream while this job appends (and, with `voxel`, voxelizes) each chunk,
+// so voxelization overlaps the read. PCD input and ROI loads are read whole before voxelizing, so
+// keep_input = false only drops their raw cloud afterwards. Loader errors surface from
+// future::get(). A set `cancel` flag stops the load at its next chunk with an empty result.
+std::future<LoadedCloud> loadAnyPointCloudAsync(const std::string& path, const LoadOptions& options = LoadOptions(),
+                                                std::shared_ptr<const std::atomic<bool>> cancel = nullptr);
+
+struct LoadRequest {
+	std::string path;
+	LoadOptions options;
+};
+
+// Bounded read-ahead over a job list: while the caller works on input i, inputs i + 1 .. i + depth
+// are being loaded, so memory holds at most depth inputs beyond the ones the caller keeps.
+// Destroying it cancels the loads still in flight and blocks until each has stopped: streamed
+// loads stop at their next chunk, while ROI loads finish their read first.
+class CloudPrefetcher {
+ public:
+	explicit CloudPrefetcher(std::vector<LoadRequest> requests, std::size_t depth = 1);
+	~CloudPrefetcher();
+
+	CloudPrefetcher(const CloudPrefetcher&) = delete;
+	CloudPrefetcher& operator=(const CloudPrefetcher&) = delete;
+
+	std::size_t size() const { return requests_.size(); }
+	bool done() const { return next_ >= requests_.size(); }
+
+	// Blocks until the next input in list order is loaded, then schedules the one after the window.
+	// Throws what the loader threw; later inputs stay scheduled, so the caller may continue.
+	LoadedCloud next();
+
+ private:
+	void refill();
+
+	std::vector<LoadRequest> requests_;
+	std::size_t depth_;
+	std::size_t next_ = 0;       // Next request handed to the caller.
+	std::size_t scheduled_ = 0;  // Next request to start loading.
+	std::shared_ptr<std::atomic<bool>> cancel_ = std::make_shared<std::atomic<bool>>(false);
+	std::deque<std::future<LoadedCloud>> pending_;
+};
+
+}  // namespace m2c
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "m2c/types.h"
+
+namespace m2c {
+
+// Brute-force neighbor search for small clouds. The build is one Morton-order sort of the finite
+// points into separate x/y/z arrays, cut into tiles of kTile points with a bounding box each. A
+// query skips the tiles whose box lies beyond its reach and runs one branch-free distance loop
+// over each remaining tile (vectorized by the compiler for SSE/AVX/NEON, whatever the target
+// offers) into an L1-resident buffer, which it then scans for hits. Same result contract as KD:
+// sorted by distance, ties by index, query point included, non-finite points never returned.
+class BruteForceIndex {
+ public:
+	static constexpr std::size_t kTile = 64;
+
+	explicit BruteForceIndex(const CloudT& cloud);
+
+	std::size_t size() const { return cloud_size_; }
+
+	// Neighbors within `r` of `query`; `max_nn` > 0 keeps only the max_nn nearest.
+	void radius(const PointT& query, float r, std::vector<int>& out, int max_nn = 0,
+	            std::vector<float>* sqr_distances = nullptr) const;
+
+	// The k nearest points to `query`, nearest first.
+	void knn(const PointT& query, int k, std::vector<int>& out, std::vector<float>* sqr_distances = nullptr) const;
+
+ private:
+	struct Box {
+		float lo[3];
+		float hi[3];
+
+		float distance2(const PointT& q) const {
+			const float dx = std::max({lo[0] - q.x, 0.0f, q.x - hi[0]});
+			const float dy = std::max({lo[1] - q.y, 0.0f, q.y - hi[1]});
+			const float dz = std::max({lo[2] - q.z, 0.0f, q.z - hi[2]});
+			return dx * dx + dy * dy + dz * dz;
+		}
+	};
+
+	// Squared distances from `query` to the points of tile `t`; returns how many are <= r2.
+	int tileDistances(const PointT& query, std::size_t t, float r2, float* d2) const;
+
+	std::size_t cloud_size_ = 0;
+	std::vector<float> x_;  // Padded to whole tiles (NaN).
+	std::vector<float> y_;
+	std::vector<float> z_;
+	std::vector<int> ids_;    // Array position -> point id.
+	std::vector<Box> boxes_;  // Bounds of each tile.
+};
+
+}  // namespace m2c
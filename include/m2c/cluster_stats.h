@@ -0,0 +1,32 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include "m2c/types.h"
+
+namespace m2c {
+
+// Per-cluster summary gathered while points are labeled, so later stages (size filter, vote,
+// validation, export) work on K summaries instead of revisiting N points.
+struct ClusterStats {
+	int count = 0;                          // Number of member points.
+	Eigen::Vector3f min = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+	Eigen::Vector3f max = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+	Eigen::Vector3f centroid = Eigen::Vector3f::Zero();
+	float nearest = std::numeric_limits<float>::infinity();  // Smallest member distance to C.
+
+	float diameter() const;                           // AABB diagonal, matching Cluster::diameter.
+	float farthestBound(const Eigen::Vector3f& C) const;  // Upper bound on any member's distance to C.
+};
+
+// Label pass: writes `labels[idx] = cluster id` for every member index (-1 elsewhere) and folds the
+// statistics of each cluster into the same sweep. The sweep is split evenly over threads in
+// cluster-major order; each thread keeps accumulators only for the contiguous id range it touches
+// and neighbouring threads merge at most one shared cluster.
+std::vector<ClusterStats> labelClusters(const CloudT& cloud,
+                                        const std::vector<PointIndices>& clusters,
+                                        const Eigen::Vector3f& C,
+                                        std::vector<int>& labels);
+
+}  // namespace m2c
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+
+#include "m2c/types.h"
+
+namespace m2c {
+
+// Compiled-in parameter defaults shared by the CLI tools.
+Params defaultParams();
+
+// Applies the `cluster:` section of a YAML file laid out like data/configs/default.yaml.
+// An empty path is a no-op; throws std::runtime_error on unreadable files or malformed values.
+void applyYamlConfig(const std::string& path, Params& params);
+
+// "fec" or "voxelcc"; throws std::runtime_error otherwise.
+ClusterAlgo parseAlgo(const std::string& value);
+
+// "flu", "opencv" or "opengl"; throws std::runtime_error otherwise.
+CameraAxes parseCameraAxes(const std::string& value);
+
+}  // namespace m2c
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <vector>
 
 #include "m2c/kdtree.h"
@@ -10,17 +11,21 @@ namespace m2c {
 struct Cluster {
 	std::vector<int> indices;  // Indices of points participating in the cluster.
 	float diameter = 0.0f;     // Estimated bounding-box diameter for validation.
+	bool truncated = false;    // Growth stopped at maxPts, so the cluster is incomplete.
 };
 
 // Seeded DBSCAN growth using pure Euclidean neighborhoods.
 // Core points expand their neighbors; boundary points join without further expansion.
 // Diameter should be approximated via an axis-aligned bounding box.
+// Growth stops once the cluster reaches maxPts (marked `truncated`) or exceeds maxDiameter.
+// `poll` (optional) is called periodically during growth and may throw to cancel.
 Cluster growFromSeed_DBSCAN(int seed_idx,
 														const CloudT& cloud,
 														const KD& kd,
 														float eps,
 														int minPts_core,
 														int maxPts,
-														float maxDiameter);
+														float maxDiameter,
+														const std::function<void()>& poll = {});
 
 }  // namespace m2c
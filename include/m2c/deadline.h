@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <stdexcept>
+
+namespace m2c {
+
+// Thrown by cooperative cancellation points once a Deadline has passed.
+struct DeadlineExceeded : std::runtime_error {
+	DeadlineExceeded() : std::runtime_error("Deadline exceeded") {}
+};
+
+// Wall-clock budget measured on the steady clock. A default-constructed deadline never expires.
+// Long-running loops call check() every few hundred iterations; it throws DeadlineExceeded.
+class Deadline {
+ public:
+	using Clock = std::chrono::steady_clock;
+
+	Deadline();                          // Unlimited budget.
+	explicit Deadline(double budget_ms); // Budget starting now; <= 0 means unlimited.
+
+	bool unlimited() const { return unlimited_; }
+	bool expired() const;                // True once the budget is spent (never for unlimited).
+	void check() const;                  // Throws DeadlineExceeded when expired().
+
+	double elapsedMs() const;            // Time since construction.
+	double remainingMs() const;          // Remaining budget, clamped at zero (infinity if unlimited).
+
+	// Child deadline that ends after `fraction` of the total budget has elapsed, never later than
+	// this one. Used to hand each fallback tier a slice while reserving time for the next.
+	Deadline slice(double fraction) const;
+
+	// This deadline, moved later if needed so that at least `min_ms` remain from now. Keeps a
+	// fallback tier runnable after an earlier tier overran its slice.
+	Deadline atLeast(double min_ms) const;
+
+ private:
+	Clock::time_point start_;
+	Clock::time_point end_;
+	bool unlimited_ = true;
+};
+
+}  // namespace m2c
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "m2c/kdtree.h"
+#include "m2c/types.h"
+
+namespace m2c {
+
+constexpr std::size_t kEpsSamples = 4096;  // Default number of sampled k-distances.
+
+struct EpsEstimate {
+	float eps = 0.0f;          // Chosen radius: the k-distance at the knee.
+	int k = 0;                 // Neighbor rank used (minPts_core, not counting the point itself).
+	std::size_t samples = 0;   // Points whose k-distance entered the sketch.
+	float knee_quantile = 0.0f;  // Position of the knee in the k-distance distribution.
+};
+
+// Estimates a clustering radius from the k-distance distribution (the classic DBSCAN heuristic):
+// the k-th nearest neighbor distance of up to `max_samples` evenly strided points is computed in
+// parallel with `kd`, streamed into per-thread quantile sketches, and eps is read at the knee of
+// the sorted curve (its largest gap below the chord between the 1% and 99% quantiles).
+// Throws std::runtime_error when the cloud is too small or all sampled distances are zero.
+// `poll` (optional) is invoked every few dozen samples on the calling thread; whatever it throws
+// cancels the estimate and is rethrown once the sampling threads have stopped.
+EpsEstimate estimateEps(const CloudT& cloud, const KD& kd, int k, std::size_t max_samples = kEpsSamples,
+                        const std::function<void()>& poll = std::function<void()>());
+
+}  // namespace m2c
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "m2c/point_attributes.h"
+#include "m2c/types.h"
+
+namespace m2c {
+
+// View volume of the camera at a pose, for dropping points it cannot see before any voxelization
+// or radius search. Pose::R maps camera axes to world axes and the camera sits at Pose::C;
+// Params::camera_axes says which camera axes are forward, left and up (by default +x, +y, +z, so
+// the yaw-only rotations of ground-level poses keep the view horizontal; OpenCV-style poses look
+// along +z with y down). A point is inside when its view-axis distance d lies in
+// [near_clip, far_clip] and its lateral and vertical offsets are within d * tan(fov / 2).
+class Frustum {
+ public:
+	// Reads Params::fov_h/fov_v/near_clip/far_clip/camera_axes; throws std::runtime_error when the
+	// pose has no usable rotation (with Pose::rotation_error) or the angles and planes are out of range.
+	Frustum(const Pose& pose, const Params& params);
+
+	// mask[i] = 1 when cloud[i] is inside, else 0 (non-finite points never are). Runs a branch-free
+	// test over blocks of kBlock points that the compiler vectorizes. Returns the number inside.
+	std::size_t contains(const CloudT& cloud, std::vector<std::uint8_t>& mask) const;
+
+	// Removes the points outside from `cloud`, keeping order, and the matching rows of `attributes`.
+	// Returns the number of points removed.
+	std::size_t cull(CloudT& cloud, PointAttributes* attributes = nullptr) const;
+
+ private:
+	static constexpr std::size_t kBlock = 64;
+
+	float origin_[3];
+	float axes_[3][3];  // World-to-camera rotation rows: view, left, up.
+	float tan_h_;
+	float tan_v_;
+	float near_;
+	float far_;         // +inf when unbounded.
+};
+
+}  // namespace m2c
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "m2c/types.h"
+#include "m2c/voxel_key.h"
+
+namespace m2c {
+
+// Exact eps-connectivity clustering that grows with the masked cloud.
+// Keeps a hashed grid (cell = eps) and a union-find forest across calls, so appending a batch
+// only queries and unions the new points against their neighborhoods. Every root carries its
+// component's size and extent, merged on union, so component count, the min_keep threshold and
+// selection (selectIncremental) never revisit the whole cloud.
+// Components are the exact connected components of the eps-graph, which pcg::FEC approximates.
+class IncrementalClusterer {
+ public:
+	// Summary of one component, kept at its root.
+	struct Component {
+		int count = 0;
+		Eigen::Vector3f min = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+		Eigen::Vector3f max = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+		Eigen::Vector3d sum = Eigen::Vector3d::Zero();  // Of member coordinates, for the centroid.
+	};
+
+	explicit IncrementalClusterer(float eps);
+
+	float eps() const { return eps_; }
+	const CloudT& cloud() const { return cloud_; }
+	std::size_t size() const { return cloud_.size(); }
+	std::size_t componentCount() const { return roots_.size(); }
+
+	// Inserts `points` and unions each one with every existing point within eps.
+	void append(const CloudT& points);
+
+	int label(int idx) const;          // Root point index of the component containing idx.
+	int componentSize(int idx) const;  // Size of the component containing idx.
+
+	// Components in no particular order; positions change when an append merges components.
+	const std::vector<int>& roots() const { return roots_; }                  // Root point of each.
+	const std::vector<Component>& components() const { return components_; }  // Aligned with roots().
+	void members(std::size_t component, std::vector<int>& out) const;         // O(component size).
+	std::vector<int> labels() const;  // Position in components() of every point; O(N).
+
+	// Snapshot in pcg::FEC layout (one PointIndices per component, by smallest member), O(N).
+	std::vector<PointIndices> clusters() const;
+
+	// Binary state file: a header, then one record per save with the points and effective unions
+	// added since the previous save, so saving again to the same file appends only the delta
+	// (any other path, or a file changed since, gets a full snapshot). load() replays the records;
+	// the grid is then filled on the next append, with only the points near that batch.
+	void save(const std::string& path);
+	static IncrementalClusterer load(const std::string& path);
+
+ private:
+	int find(int idx) const;
+	bool unite(int a, int b);  // False when already connected.
+	int add(const PointT& p);  // New point in its own component; returns its index.
+	VoxelFrame gridFrame(const CloudT& batch) const;  // Anchored at the first stored point.
+	void prepareGrid(const CloudT& batch, const VoxelFrame& frame);  // Makes the grid hold every point near `batch`.
+
+	float eps_;
+	CloudT cloud_;
+	mutable std::vector<int> parent_;  // Path-halving in find() mutates parents only.
+	std::vector<int> next_;            // Circular member lists: next_ from a root visits its component.
+	std::vector<int> slot_;            // Root -> position in roots_ / components_; -1 elsewhere.
+	std::vector<int> roots_;
+	std::vector<Component> components_;
+	std::unordered_map<VoxelKey, std::vector<int>, VoxelKeyHash> grid_;
+	// After load() the grid holds only the points inside [grid_min_, grid_max_] (an empty box at
+	// first) until a batch reaches outside it and the whole cloud is indexed.
+	bool grid_complete_ = true;
+	Eigen::Vector3f grid_min_ = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+	Eigen::Vector3f grid_max_ = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+
+	// The state file save() appends to, its expected size, and what it does not hold yet.
+	std::string journal_path_;
+	std::uint64_t journal_bytes_ = 0;
+	std::size_t saved_points_ = 0;
+	std::vector<std::pair<int, int>> unsaved_unions_;
+};
+
+}  // namespace m2c
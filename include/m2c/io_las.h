@@ -1,14 +1,39 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <string>
 
+#include "m2c/point_attributes.h"
 #include "m2c/types.h"
 
 namespace m2c {
 
 // Load the masked point cloud from disk, prioritizing LAS via PDAL when available.
-// Falls back to PLY/PCD ingestion through PCL IO when LAS support is disabled or missing.
+// Without PDAL, uncompressed LAS is read natively. PLY/PCD go through PCL IO, or in M2C_CORE_ONLY
+// builds through the native PLY reader (PCD is unavailable there).
 // Implementations should return nullptr and surface descriptive errors when loading fails.
-CloudT::Ptr loadAnyPointCloud(const std::string& path);
+// With `roi`, only points inside the sphere are returned; an uncompressed LAS indexed by m2c_index
+// is then read natively, touching only the record ranges of overlapping cells.
+// With `attributes`, the intensity, classification and RGB columns the source provides are loaded
+// in the same pass, index-aligned with the returned cloud (PCD inputs yield none). LAS scan angle
+// and GPS time are added when attributes->scan_order is set.
+CloudT::Ptr loadAnyPointCloud(const std::string& path,
+                              const Roi* roi = nullptr,
+                              PointAttributes* attributes = nullptr);
+
+// Streams the cloud in chunks of at most `chunk_points` points, in file order, so callers can
+// process inputs larger than memory. LAS uses PDAL's streaming mode (the native reader without
+// PDAL) and PLY a native reader; PCD (and PLY layouts the native reader rejects) are loaded
+// whole and then chunked. With `attributes`, it holds the delivered chunk's attribute columns
+// while the callback runs.
+void forEachPointChunk(const std::string& path,
+                       std::size_t chunk_points,
+                       const std::function<void(const CloudT&)>& callback,
+                       PointAttributes* attributes = nullptr);
+
+// Point count declared in the LAS or PLY header, read without touching the records, so chunked
+// loaders can size their output once. 0 when unknown (PCD, unreadable header).
+std::size_t pointCountHint(const std::string& path);
 
 }  // namespace m2c
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "m2c/point_attributes.h"
+#include "m2c/types.h"
+
+namespace m2c {
+
+// Streaming binary PLY export (float x/y/z in host byte order), written straight from `cloud`
+// through an index list without building an intermediate cloud. Records are staged in a fixed
+// 1 MiB buffer and flushed with large write() calls. Out-of-range indices are skipped.
+// Returns the number of vertices written; throws std::runtime_error on I/O failure.
+// With `attributes` (index-aligned with `cloud`), each present column is gathered by the same
+// indices into `ushort intensity`, `uchar classification` and `red/green/blue` (uchar for 8-bit
+// sources, ushort otherwise) properties after x/y/z.
+std::size_t writePlyBinary(const std::string& path,
+                           const CloudT& cloud,
+                           const std::vector<int>& indices,
+                           const PointAttributes* attributes = nullptr);
+
+// Writes every point of `cloud` with an extra `int cluster` property taken from `labels`
+// (same length as the cloud; -1 marks unlabeled points) so downstream tools need not recluster.
+// `attributes` are exported as in writePlyBinary.
+std::size_t writePlyLabeled(const std::string& path,
+                            const CloudT& cloud,
+                            const std::vector<int>& labels,
+                            const PointAttributes* attributes = nullptr);
+
+// Streams the x/y/z of a PLY file (ascii, binary_little_endian or binary_big_endian; float or
+// double coordinates; vertex element first) in chunks of at most `chunk_points`, without ever
+// holding the whole cloud. Returns false when the layout is not supported by the native reader
+// (the caller may then fall back to PCL IO); throws std::runtime_error on malformed input.
+// With `attributes`, it holds the chunk's `intensity`, `classification` and `red/green/blue`
+// vertex properties (whichever exist) while the callback runs.
+bool forEachPlyChunk(const std::string& path,
+                     std::size_t chunk_points,
+                     const std::function<void(const CloudT&)>& callback,
+                     PointAttributes* attributes = nullptr);
+
+}  // namespace m2c
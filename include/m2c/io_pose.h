@@ -6,8 +6,10 @@
 
 namespace m2c {
 
-// Load pose data from a JSON file, using only translation.x/y/z to populate Pose::C.
-// Future implementation may rely on header-only nlohmann::json; rotation data is ignored.
+// Load pose data from a JSON file: translation.x/y/z populate Pose::C, and the optional
+// rotation.{x,y,z,w} quaternion (camera to world) populates Pose::R. Only the frustum prefilter
+// uses the rotation; selection itself stays translation-only, so a rotation that cannot be read is
+// recorded in Pose::rotation_error rather than thrown (Frustum reports it).
 Pose loadPoseJSON(const std::string& json_path);
 
 }  // namespace m2c
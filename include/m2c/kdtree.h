@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -7,12 +9,92 @@
 
 namespace m2c {
 
-// Thin wrapper around pcl::search::KdTree<PointT> to support radius queries.
+enum class SearchBackend {
+	Auto,        // Chosen per cloud by chooseSearchBackend.
+	Tree,        // pcl::search::KdTree, or the built-in kd-tree in M2C_CORE_ONLY builds.
+	BruteForce,  // BruteForceIndex: one sort to build, vectorized scans of the nearby tiles.
+};
+
+// Crossovers for SearchBackend::Auto, measured with `kd_probe --calibrate` (FEC workload: build
+// plus one radius query per point, 0.05 m spacing, core-only build) on the development machine;
+// they are machine-specific. The pipeline takes them from the kd_* keys of Params, so rerun the
+// probe on the target machine (or for PCL builds) and paste its output into the YAML config.
+struct KDOptions {
+	SearchBackend backend = SearchBackend::Auto;
+	std::size_t brute_force_max_points = 4096;  // Brute force at or below this many points.
+	// Brute force up to compact_max_points when a query of `radius_hint` is expected to cover at
+	// least this fraction of the cloud's bounding box: the tree would visit most leaves anyway.
+	float brute_force_min_coverage = 1.0f / 64.0f;
+	std::size_t compact_max_points = 65536;
+	float radius_hint = 0.0f;  // Typical query radius; 0 disables the coverage rule.
+	// Invoked while the index is built (between subtrees of large clouds); it may throw to cancel
+	// the build, e.g. on a Deadline. The PCL tree polls only before and after its build.
+	std::function<void()> poll;
+};
+
+// Backend that KD(cloud, options) uses: options.backend unless Auto. The coverage of a radius-r
+// query is the product over axes of min(1, 2r / extent), so flat or thin clouds count as compact
+// along their thin axis.
+SearchBackend chooseSearchBackend(const CloudT& cloud, const KDOptions& options);
+
+// Output buffers one thread reuses across queries: kept capacity means steady-state queries
+// allocate nothing. Give each thread its own.
+struct KDScratch {
+	std::vector<int> indices;
+	std::vector<float> sqr_distances;
+};
+
+// Results of a batched query in CSR form: the neighbors of query q are
+// indices[offsets[q], offsets[q + 1]), nearest first, with the matching sqr_distances. Reusing one
+// result across batches keeps the capacity of every buffer, the per-block staging included.
+struct KDBatchResult {
+	std::vector<std::size_t> offsets;  // One entry per query, plus the end.
+	std::vector<int> indices;
+	std::vector<float> sqr_distances;
+	std::vector<KDScratch> blocks;     // Parallel runs only: staging, one per block of consecutive queries.
+
+	std::size_t queries() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+	std::size_t count(std::size_t q) const { return offsets[q + 1] - offsets[q]; }
+};
+
+// Radius and kNN queries over a fixed cloud: wraps pcl::search::KdTree<PointT>, or the built-in
+// kd-tree in M2C_CORE_ONLY builds, or a BruteForceIndex for small clouds (see KDOptions).
+// Results are sorted by distance; index queries include the query point.
 // Callers should preallocate the output index buffer to minimize reallocations.
+// Thread safety: queries never modify the KD, and their working memory is thread_local or owned by
+// the caller, so any number of threads may query one KD concurrently (each with its own output
+// buffers). The cloud must outlive the KD and stay unmodified.
 struct KD {
-	explicit KD(const CloudT& cloud);
+	explicit KD(const CloudT& cloud, const KDOptions& options = KDOptions());
+
+	SearchBackend backend() const;
+	std::size_t size() const;  // Points in the indexed cloud (the valid query indices).
+
+	// `max_nn` > 0 keeps only the max_nn nearest neighbors. `sqr_distances`, when given, receives
+	// the matching squared distances.
+	void radius(int idx, float r, std::vector<int>& out, int max_nn = 0,
+	            std::vector<float>* sqr_distances = nullptr) const;
+
+	// The same around an arbitrary point (which need not belong to the cloud, e.g. the reference
+	// point C); a non-finite `query` has no neighbors.
+	void radius(const PointT& query, float r, std::vector<int>& out, int max_nn = 0,
+	            std::vector<float>* sqr_distances = nullptr) const;
+
+	// The k nearest neighbors of point idx, itself included, nearest first (fewer when the cloud is
+	// smaller). `sqr_distances`, when given, receives the matching squared distances.
+	void knn(int idx, int k, std::vector<int>& out, std::vector<float>* sqr_distances = nullptr) const;
+
+	// The k points nearest to an arbitrary point.
+	void knn(const PointT& query, int k, std::vector<int>& out, std::vector<float>* sqr_distances = nullptr) const;
 
-	void radius(int idx, float r, std::vector<int>& out) const;
+	// Batched forms of the queries above, one per index or per point of `queries`, written to `out`
+	// in query order. Blocks of consecutive queries run in parallel on the OpenMP threads (when
+	// built with OpenMP); the results match the single queries exactly. Index batches are
+	// bounds-checked up front and throw std::out_of_range before any query runs.
+	void radiusBatch(const std::vector<int>& indices, float r, KDBatchResult& out, int max_nn = 0) const;
+	void radiusBatch(const CloudT& queries, float r, KDBatchResult& out, int max_nn = 0) const;
+	void knnBatch(const std::vector<int>& indices, int k, KDBatchResult& out) const;
+	void knnBatch(const CloudT& queries, int k, KDBatchResult& out) const;
 
  private:
 	struct State;
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "m2c/point_attributes.h"
+#include "m2c/types.h"
+
+namespace m2c {
+
+struct LasIndexOptions {
+	float cell = 0.0f;                                // XY cell edge in meters; 0 derives it from the density.
+	std::size_t points_per_cell = 65536;              // Target mean cell occupancy when `cell` is 0.
+	std::size_t buffer_bytes = std::size_t(64) << 20;  // Scatter buffers shared by all cells while reordering.
+};
+
+struct LasIndexSummary {
+	std::uint64_t points = 0;
+	float cell = 0.0f;
+	std::uint32_t nx = 0;
+	std::uint32_t ny = 0;
+	std::size_t occupied = 0;  // Non-empty cells.
+};
+
+// Streams the x/y/z of an uncompressed LAS file (any point format, LAS 1.0-1.4) in chunks of at
+// most `chunk_points`, without PDAL. With `attributes`, it holds the intensity, classification and
+// (formats 2, 3, 5, 7, 8, 10) RGB of the chunk being delivered. Returns false for compressed (LAZ)
+// records; throws on malformed input.
+bool forEachLasChunk(const std::string& las_path,
+                     std::size_t chunk_points,
+                     const std::function<void(const CloudT&)>& callback,
+                     PointAttributes* attributes = nullptr);
+
+// Point count declared in the LAS header (LAZ included), without reading any records.
+std::uint64_t lasPointCount(const std::string& las_path);
+
+// Sidecar written next to an indexed LAS file: "<las_path>.m2ci".
+std::string lasIndexPath(const std::string& las_path);
+
+// Rewrites the point records of an uncompressed LAS file grouped by XY grid cell and writes the
+// sidecar holding each cell's record range and z extent. Header, VLRs and EVLRs are kept byte for
+// byte (LAS does not define a point order). Three sequential passes; memory is bounded by the grid
+// and `buffer_bytes`, not by the file.
+LasIndexSummary buildLasIndex(const std::string& las_path, const LasIndexOptions& options = LasIndexOptions());
+
+// Reads only the record ranges of cells overlapping `roi` (pread) and returns the points inside it.
+// Returns nullptr when there is no sidecar or it no longer matches the LAS file's size and mtime.
+// `attributes` (optional) receives the returned points' attributes, as in forEachLasChunk.
+CloudT::Ptr loadLasRegion(const std::string& las_path, const Roi& roi, PointAttributes* attributes = nullptr);
+
+}  // namespace m2c
@@ -1,20 +1,79 @@
 #pragma once
 
+#include <vector>
+
+#include "m2c/cluster_stats.h"
 #include "m2c/dbscan_seeded.h"
 #include "m2c/types.h"
 #include "m2c/validator.h"
 
 namespace m2c {
 
+class IncrementalClusterer;
+class ScanGrid;
+
+// Execution tiers tried in order when Params::deadline is set (Seeded also after a rejected winner).
+enum class Tier {
+	Primary,  // Requested engine (params.algo) on the working cloud.
+	Coarse,   // FEC with the same eps on the cloud re-voxelized at max(2 * voxel, eps / 2).
+	Seeded,   // Seeded DBSCAN grown from the points nearest to C inside a local crop.
+};
+
+struct TierReport {
+	Tier tier = Tier::Primary;
+	double budget_ms = 0.0;   // Time the tier was allowed to use (0 when no deadline is set).
+	double elapsed_ms = 0.0;  // Time the tier actually used.
+	bool completed = false;   // False when the tier was cancelled by the deadline.
+	bool rejected = false;    // True when the tier completed but its winner failed validation.
+};
+
 struct Result {
 	bool found = false;  // True when a qualifying cluster is produced.
+	bool rejected = false;  // True when a cluster was voted but failed minPts_total / maxDiameter.
 	int trials = 0;      // Number of seed attempts made.
 	Cluster cluster;     // Captured cluster (valid when found == true).
+	Tier tier = Tier::Primary;       // Tier that produced the answer.
+	std::vector<TierReport> tiers;   // One entry per tier attempted, in order.
+	// Labeling summary from the primary/coarse tiers (empty when the seeded tier answered).
+	std::vector<ClusterStats> stats; // One summary per labeled cluster, indexed by cluster id.
+	std::vector<int> labels;         // Cluster id of every input point (-1 when unlabeled).
+	int cluster_id = -1;             // Id of the selected cluster in `stats` (pre-refinement).
+	int min_keep = 0;                // Size threshold floor(n * mean_size) applied before voting.
+	float eps = 0.0f;                // Radius used for labeling (the estimate when params.eps_auto).
 };
 
+const char* tierName(Tier tier);
+
 // Orchestrate FEC-based cluster selection around reference point C.
 // Steps: run FEC with radius `eps`, discard clusters smaller than floor(n * mean_size),
-// then select the cluster that has majority among the `m` nearest-to-C points (ties broken by total distance).
-Result selectCluster(const CloudT& cloud, const Pose& pose, const Params& params);
+// then select the cluster that has majority among the `m` nearest-to-C points (ties broken by total
+// distance, then by the lowest cluster id). The winner must pass the Validator (minPts_total,
+// maxDiameter) on its summary; when it fails, the seeded tier is tried instead, also without a deadline.
+// With params.algo == ClusterAlgo::VoxelCC the labeling uses voxel connectivity instead of FEC;
+// params.refine then splits only the winning component with exact FEC and re-votes inside it.
+// With params.deadline > 0 the clustering and voting loops check the budget cooperatively; when it
+// runs out the next tier is tried (Primary gets 60% of the budget, Coarse up to 85% but never less
+// than 25% from its start, Seeded the rest). The Seeded tier is never cancelled, so a deadline still
+// yields a cluster whenever one qualifies, possibly after the budget.
+// With params.eps_auto, eps is first estimated from the cloud (see estimateEps) within the Primary
+// tier's slice and reported in Result::eps; when that is cancelled, the fallback tiers estimate it
+// from the points nearest to C.
+// `scan_grid` (an organized input, built over `cloud`) serves the primary tier's FEC radius queries;
+// the other tiers and refinement index their own clouds as usual.
+Result selectCluster(const CloudT& cloud, const Pose& pose, const Params& params, const ScanGrid* scan_grid = nullptr);
+
+// Size filter + vote + validation over an existing labeling, skipping the clustering stage. Cluster
+// indices refer to `cloud`; deadline tiers (and the seeded fallback) do not apply.
+Result selectFromClusters(const CloudT& cloud,
+                          const std::vector<PointIndices>& clusters,
+                          const Pose& pose,
+                          const Params& params);
+
+// The same over the components of an incremental labeling, read from their per-root summaries: no
+// pass over all points, only over the members of the components near C. Indices refer to
+// state.cloud(); Result::stats holds one summary per entry of state.components() (cluster_id is a
+// position there), with `nearest` the distance from C to the component's box, and Result::labels
+// is left empty (see IncrementalClusterer::labels()).
+Result selectIncremental(const IncrementalClusterer& state, const Pose& pose, const Params& params);
 
 }  // namespace m2c
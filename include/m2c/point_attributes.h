@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace m2c {
+
+// LAS-style per-point attributes kept in columns beside the XYZ cloud and index-aligned with it,
+// so clustering keeps scanning plain XYZ points. Columns the source does not provide stay empty.
+struct PointAttributes {
+	std::vector<std::uint16_t> intensity;
+	std::vector<std::uint8_t> classification;
+	std::vector<std::uint16_t> red;  // red/green/blue are filled together or not at all.
+	std::vector<std::uint16_t> green;
+	std::vector<std::uint16_t> blue;
+	int color_bits = 16;             // 8 for PLY uchar colors, 16 for LAS.
+	// Scanner geometry for rebuilding the scan grid (see ScanGrid). Not exported, and only loaded from
+	// LAS when `scan_order` is set before reading; clear() keeps the flag and select() copies it.
+	bool scan_order = false;
+	std::vector<float> scan_angle;   // Degrees.
+	std::vector<double> gps_time;
+
+	bool hasIntensity() const { return !intensity.empty(); }
+	bool hasClassification() const { return !classification.empty(); }
+	bool hasColor() const { return !red.empty(); }
+	bool hasScanOrder() const { return !scan_angle.empty() && !gps_time.empty(); }
+	bool empty() const { return !hasIntensity() && !hasClassification() && !hasColor() && scan_angle.empty() && gps_time.empty(); }
+
+	void clear();
+	// Appends the rows of `other` (a later chunk of the same source).
+	void append(const PointAttributes& other);
+	// Rows `indices`, in that order (e.g. the points kept by a crop or voxel filter).
+	PointAttributes select(const std::vector<int>& indices) const;
+};
+
+}  // namespace m2c
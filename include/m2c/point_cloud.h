@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace m2c {
+namespace core {
+
+// Internal stand-ins for the handful of PCL types the pipeline relies on (M2C_CORE_ONLY builds).
+// Member names mirror PCL so pipeline code compiles unchanged against either backend.
+
+struct PointXYZ {
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+
+	PointXYZ() = default;
+	PointXYZ(float px, float py, float pz) : x(px), y(py), z(pz) {}
+};
+
+template <typename PointT>
+struct PointCloud {
+	using Ptr = std::shared_ptr<PointCloud<PointT>>;
+	using ConstPtr = std::shared_ptr<const PointCloud<PointT>>;
+	using iterator = typename std::vector<PointT>::iterator;
+	using const_iterator = typename std::vector<PointT>::const_iterator;
+
+	std::vector<PointT> points;
+	std::uint32_t width = 0;
+	std::uint32_t height = 1;
+	bool is_dense = false;
+
+	std::size_t size() const { return points.size(); }
+	bool empty() const { return points.empty(); }
+	void reserve(std::size_t n) { points.reserve(n); }
+	void resize(std::size_t n) {
+		points.resize(n);
+		width = static_cast<std::uint32_t>(n);
+		height = 1;
+	}
+	void clear() {
+		points.clear();
+		width = 0;
+		height = 1;
+	}
+	void push_back(const PointT& p) {
+		points.push_back(p);
+		width = static_cast<std::uint32_t>(points.size());
+		height = 1;
+	}
+
+	PointT& operator[](std::size_t i) { return points[i]; }
+	const PointT& operator[](std::size_t i) const { return points[i]; }
+	iterator begin() { return points.begin(); }
+	iterator end() { return points.end(); }
+	const_iterator begin() const { return points.begin(); }
+	const_iterator end() const { return points.end(); }
+};
+
+struct PointIndices {
+	using Ptr = std::shared_ptr<PointIndices>;
+	std::vector<int> indices;
+};
+
+}  // namespace core
+}  // namespace m2c
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+namespace m2c {
+
+// Streaming, mergeable quantile sketch with relative accuracy (DDSketch-style log buckets).
+// Non-negative values only; a returned quantile is within `relative_accuracy` of a true sample
+// of that rank. Memory grows with log(max / min), not with the number of values.
+class QuantileSketch {
+ public:
+	explicit QuantileSketch(double relative_accuracy = 0.01);
+
+	void add(double value);
+	void merge(const QuantileSketch& other);  // Both sketches must share the accuracy.
+
+	std::uint64_t count() const { return count_; }
+	double quantile(double q) const;  // q in [0, 1]; 0 when empty.
+
+ private:
+	double gamma_;
+	double log_gamma_;
+	std::uint64_t zeros_ = 0;
+	std::uint64_t count_ = 0;
+	std::map<int, std::uint64_t> buckets_;  // Bucket i holds values in (gamma^(i-1), gamma^i].
+};
+
+}  // namespace m2c
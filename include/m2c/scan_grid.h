@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "m2c/kdtree.h"
+#include "m2c/point_attributes.h"
+#include "m2c/types.h"
+
+namespace m2c {
+
+struct ScanGridOptions {
+	float line_gap = 8.0f;      // A time gap this many times what the angle advanced explains starts a new line.
+	int max_window = 3;         // Largest half-width, in cells, a query window may grow to before falling back.
+	float min_occupancy = 0.5f; // Below this many occupied cells per point, lines were not told apart.
+	std::size_t max_cells_per_point = 16;  // Sparser grids (bad angle or time data) are rejected.
+};
+
+// The 2D scan grid of a terrestrial (scanline-ordered) input, rebuilt from LAS scan angle and GPS
+// time, so neighbor queries read a small window of cells instead of a spatial index. Points are
+// ordered by GPS time; a scanline ends where the scan angle turns back against its sweep (mirror
+// reset or reversal) or the time jumps further than the angle advanced. Rows are scanlines and
+// columns are scan angle steps (the median angle increment). A cell holds every point of its line
+// and step, so multiple returns of one pulse share it.
+class ScanGrid {
+ public:
+	ScanGrid() = default;
+
+	// `scan` is index-aligned with `cloud` and needs scan_angle and gps_time; without them, or when
+	// the angles and times do not form a grid, the result is not valid().
+	ScanGrid(const CloudT& cloud, const PointAttributes& scan, const ScanGridOptions& options = ScanGridOptions());
+
+	bool valid() const { return rows_ > 0; }
+	int rows() const { return rows_; }
+	int cols() const { return cols_; }
+	std::size_t placed() const { return placed_; }  // Points with a cell (the finite ones).
+
+	// Neighbors of point `idx` within `r`, with the KD::radius contract (sorted by distance, ties by
+	// index, query point included, `max_nn` > 0 keeps the nearest). The window around the point's
+	// cell grows one ring of cells at a time while the outer ring still holds a point within `r`
+	// (with `max_nn`, once that many are found: nearer than the max_nn-th so far) or holds no point
+	// at all, so it follows the surface rather than an assumed spacing. Returns
+	// false, leaving `out` unspecified, where the grid cannot answer: the point has no cell or the
+	// window would grow past max_window.
+	bool radius(const CloudT& cloud, int idx, float r, std::vector<int>& out, int max_nn = 0) const;
+
+ private:
+	// Points of cell (row, col); empty outside the grid.
+	std::pair<const int*, const int*> cell(int row, int col) const {
+		if (row < 0 || row >= rows_ || col < 0 || col >= cols_) return {nullptr, nullptr};
+		const std::size_t c = static_cast<std::size_t>(row) * static_cast<std::size_t>(cols_) + static_cast<std::size_t>(col);
+		return {ids_.data() + start_[c], ids_.data() + start_[c + 1]};
+	}
+
+	int rows_ = 0;
+	int cols_ = 0;
+	int max_window_ = 3;
+	std::size_t placed_ = 0;
+	std::vector<int> start_;  // Row-major cell -> first entry in ids_ (one past the end last).
+	std::vector<int> ids_;    // Point ids grouped by cell.
+	std::vector<int> row_;    // Per point; -1 without a cell.
+	std::vector<int> col_;
+};
+
+// Radius queries for FEC over an organized cloud: the scan grid answers where it can and a KD
+// over the whole cloud, built on the first query the grid declines, answers the rest. `index`, when
+// given, is an existing KD over `cloud` that answers them instead.
+class ScanGridSearch {
+ public:
+	ScanGridSearch(const CloudT& cloud, const ScanGrid& grid, const KDOptions& options = KDOptions(),
+	               const KD* index = nullptr);
+
+	void radius(int idx, float r, std::vector<int>& out, int max_nn = 0) const;
+
+	std::size_t gridQueries() const { return grid_queries_; }
+	std::size_t fallbackQueries() const { return fallback_queries_; }
+
+ private:
+	const CloudT& cloud_;
+	const ScanGrid& grid_;
+	KDOptions options_;
+	const KD* index_;
+	mutable std::once_flag fallback_once_;
+	mutable std::unique_ptr<KD> fallback_;
+	mutable std::atomic<std::size_t> grid_queries_{0};
+	mutable std::atomic<std::size_t> fallback_queries_{0};
+};
+
+}  // namespace m2c
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "m2c/pipeline.h"
+#include "m2c/types.h"
+
+namespace m2c {
+
+struct TiledOptions {
+	float tile_size = 50.0f;                      // XY edge of a tile; rounded up to a multiple of voxel.
+	std::size_t memory_budget = std::size_t(1) << 30;  // Bytes of spill buffers, then of tile working sets, resident at once.
+	std::size_t chunk_points = std::size_t(1) << 20;   // Streaming read granularity.
+	int threads = 0;                              // Tile workers; 0 uses the hardware concurrency.
+	std::string work_dir;                         // Spill directory parent (default: system temp dir).
+	bool keep_work_dir = false;                   // Keep tile files for inspection.
+};
+
+struct TiledSelection {
+	Result result;                   // cluster.indices index into `points`; stats cover every global component.
+	CloudT::Ptr points;              // Coordinates of the selected cluster.
+	std::vector<std::uint64_t> ids;  // Input point id (file order) per selected point; with voxel > 0, the
+	                                 // first input point of its voxel.
+	std::size_t tiles = 0;           // Tiles produced by the spill pass.
+	std::size_t tiles_voted = 0;     // Tiles read back for the top-m vote.
+};
+
+// Out-of-core variant of selectCluster for clouds larger than memory.
+// 1) Streams the input into XY tiles on disk. 2) Voxelizes (origin-anchored, so tile borders align
+// with voxel borders) and labels each tile independently with exact eps-connectivity, in parallel
+// under `memory_budget`. 3) Merges components across tile borders by re-checking only points within
+// eps of a seam. 4) Filters by size and votes around C, reading back only tiles within reach of C;
+// a winner that fails the Validator is reported as rejected (no seeded fallback here).
+// The partition equals exact eps-connectivity over the whole voxelized cloud (IncrementalClusterer).
+TiledSelection selectClusterTiled(const std::string& path,
+                                  const Pose& pose,
+                                  const Params& params,
+                                  const TiledOptions& options);
+
+}  // namespace m2c
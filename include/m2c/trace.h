@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace m2c {
+namespace trace {
+
+// Lightweight in-process tracer that exports Chrome/Perfetto trace-event JSON.
+// Spans are recorded into per-thread ring buffers (single writer, no locks on the hot path;
+// the oldest spans are overwritten when a buffer wraps). Everything below compiles to no-ops
+// unless M2C_ENABLE_TRACE is defined (CMake option M2C_WITH_TRACE).
+#ifdef M2C_ENABLE_TRACE
+constexpr bool kCompiledIn = true;
+#else
+constexpr bool kCompiledIn = false;
+#endif
+
+void start();                                // Enable recording; timestamps are relative to this call.
+bool active();                               // True while recording.
+// Stops recording, then writes every span recorded so far. Safe while other threads are still in
+// traced code: spans they close from here on are dropped, and so are slots a wrapping ring
+// overwrites during the copy. Export after workers join for a complete timeline.
+// Throws std::runtime_error on I/O failure.
+void writeChromeTrace(const std::string& path);
+
+// RAII span; records [construction, destruction) under `name`, which must be a string literal.
+class Scope {
+ public:
+	explicit Scope(const char* name);
+	~Scope();
+
+	Scope(const Scope&) = delete;
+	Scope& operator=(const Scope&) = delete;
+
+ private:
+	const char* name_;
+	std::int64_t begin_ns_;
+};
+
+}  // namespace trace
+}  // namespace m2c
+
+#define M2C_TRACE_CONCAT_INNER(a, b) a##b
+#define M2C_TRACE_CONCAT(a, b) M2C_TRACE_CONCAT_INNER(a, b)
+
+#ifdef M2C_ENABLE_TRACE
+#define M2C_TRACE_SCOPE(name) ::m2c::trace::Scope M2C_TRACE_CONCAT(m2c_trace_scope_, __LINE__)(name)
+#else
+#define M2C_TRACE_SCOPE(name) ((void)0)
+#endif
@@ -1,20 +1,58 @@
 #pragma once
 
+#include <string>
+
 #include <Eigen/Core>
+
+#ifdef M2C_CORE_ONLY
+#include "m2c/point_cloud.h"
+#else
+#include <pcl/PointIndices.h>
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
+#endif
 
 namespace m2c {
 
+#ifdef M2C_CORE_ONLY
+using PointT = core::PointXYZ;
+using CloudT = core::PointCloud<PointT>;
+using PointIndices = core::PointIndices;
+#else
 using PointT = pcl::PointXYZ;      // Basic XYZ point used across the pipeline.
 using CloudT = pcl::PointCloud<PointT>;  // Shared point cloud container alias.
+using PointIndices = pcl::PointIndices;  // Cluster membership as produced by FEC.
+#endif
+
+// Labeling engine used by selectCluster.
+enum class ClusterAlgo {
+	FEC,      // Fast Euclidean Clustering over point-level radius searches.
+	VoxelCC,  // Approximate preview: 26-connected components of occupied eps-sized voxels.
+};
+
+// Camera axis convention of the pose rotation; only the frustum prefilter uses it.
+enum class CameraAxes {
+	ForwardLeftUp,  // +x forward, +y left, +z up (robotics body frame).
+	OpenCV,         // +z forward, +x right, +y down (OpenCV, COLMAP and most photogrammetry).
+	OpenGL,         // -z forward, +x right, +y up.
+};
 
 struct Pose {
-	Eigen::Vector3f C;  // Reference point derived solely from pose translation.
+	Eigen::Vector3f C;                            // Reference point derived solely from pose translation.
+	Eigen::Matrix3f R = Eigen::Matrix3f::Identity();  // Camera-to-world rotation (pose `rotation`).
+	bool has_rotation = false;                    // False when the pose file carries no usable rotation.
+	std::string rotation_error;                   // Why a present `rotation` was unusable (for Frustum).
+};
+
+// Sphere around C used to load only the neighborhood that can affect a selection.
+struct Roi {
+	Eigen::Vector3f center;
+	float radius;
 };
 
 struct Params {
 	float eps;          // DBSCAN neighborhood radius (meters).
+	bool eps_auto;      // Estimate eps from the k-distance distribution (k = minPts_core) instead.
 	int minPts_core;    // Minimum neighbors for a core point.
 	int minPts_total;   // Minimum total points required for an accepted cluster.
 	float maxDiameter;  // Maximum spatial diameter allowed for accepted clusters.
@@ -24,6 +62,22 @@ struct Params {
 	// FEC-based selection parameters
 	float n;            // Fraction multiplier for mean cluster size: floor(n * mean_size).
 	int m;              // Top-M nearest points to C for voting among clusters.
+	ClusterAlgo algo;   // Labeling engine; FEC unless a fast preview is requested.
+	bool refine;        // VoxelCC only: rerun exact FEC inside the winning component.
+	float deadline;     // Wall-clock budget for selectCluster in milliseconds; 0 disables fallbacks.
+	// Camera-frustum prefilter built from the pose rotation (see Frustum); off by default.
+	bool frustum;       // Drop points outside the camera's view before voxelization and clustering.
+	float fov_h;        // Full horizontal field of view in degrees.
+	float fov_v;        // Full vertical field of view in degrees.
+	float near_clip;    // Nearest kept distance along the view axis (meters).
+	float far_clip;     // Farthest kept distance along the view axis (meters); 0 leaves it unbounded.
+	CameraAxes camera_axes;  // Which camera axes the pose rotation treats as forward, left and up.
+	bool organized;     // Rebuild the LAS scan grid (see ScanGrid) for FEC neighbor queries; needs voxel = 0.
+	// Neighbor-search backend crossovers (see KDOptions). Machine-specific: `kd_probe --calibrate`
+	// prints the values measured on the current machine.
+	int kd_brute_force_max_points;      // Brute force at or below this many points.
+	float kd_brute_force_min_coverage;  // Brute force when an eps query covers this fraction of the bbox...
+	int kd_compact_max_points;          // ...and the cloud has at most this many points.
 };
 
 }  // namespace m2c
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "m2c/cluster_stats.h"
 #include "m2c/dbscan_seeded.h"
 
 namespace m2c {
@@ -8,8 +9,11 @@ struct Validator {
 	int minPtsTotal;     // Minimum cluster size required for acceptance.
 	float maxDiameter;   // Maximum allowable diameter before rejection.
 
-	bool pass(const Cluster& cluster) const;       // True when |S| >= minPtsTotal and diameter <= maxDiameter.
+	bool pass(const Cluster& cluster) const;       // True when |S| >= minPtsTotal, diameter <= maxDiameter and growth was not truncated.
 	bool sureNoise(const Cluster& cluster) const;  // True when the cluster is clearly underpopulated noise (|S| << minPtsTotal).
+
+	// Same size and diameter checks on a labeling summary, so a voted cluster is screened without its points.
+	bool pass(const ClusterStats& stats) const;
 };
 
 }  // namespace m2c
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "m2c/point_attributes.h"
+#include "m2c/types.h"
+#include "m2c/voxel_key.h"
+
+namespace m2c {
+
+// Voxel grid filter anchored at the origin, so voxel boundaries sit at integer multiples of
+// `leaf` (the same partition pcl::VoxelGrid uses). Emits one centroid per occupied voxel, in
+// order of first appearance. When `first_source` is given it receives, per output point, the
+// index of the first input point that fell into its voxel; `voxel_of` receives, per input point,
+// the index of its output point (-1 for non-finite points). `poll` (optional) is called
+// periodically and may throw to cancel.
+CloudT::Ptr voxelDownsample(const CloudT& cloud, float leaf, std::vector<int>* first_source = nullptr,
+                            std::vector<int>* voxel_of = nullptr, const std::function<void()>& poll = {});
+
+// The CLI's `voxel` step: pcl::VoxelGrid in PCL builds, voxelDownsample reordered to VoxelGrid's
+// output order in M2C_CORE_ONLY builds. `first_source` is filled as in voxelDownsample (used to
+// carry point attributes over to the centroids); requesting it selects the native path in PCL
+// builds too, with the same output.
+CloudT::Ptr voxelFilter(const CloudT::Ptr& cloud, float leaf, std::vector<int>* first_source = nullptr);
+
+// Incremental voxelFilter for input that arrives in chunks (e.g. while a file is still being
+// decoded): add() the chunks in input order, then finish() emits the same centroids in the same
+// order as voxelFilter over the concatenated input. Point ids continue across chunks. Memory grows
+// with the occupied voxels only, so the input itself need not be kept.
+class VoxelAccumulator {
+ public:
+	explicit VoxelAccumulator(float leaf);
+
+	// `attributes` (index-aligned with `chunk`) lets finish() return per-voxel attributes; pass them
+	// with every chunk or with none.
+	void add(const CloudT& chunk, const PointAttributes* attributes = nullptr);
+	std::size_t voxels() const { return sums_.size(); }
+	std::size_t pointsSeen() const { return seen_; }
+
+	// `first_source` receives, per output point, the id of the first input point in its voxel, and
+	// `attributes` that point's attributes.
+	CloudT::Ptr finish(std::vector<int>* first_source = nullptr, PointAttributes* attributes = nullptr) const;
+
+ private:
+	struct Sum {
+		double x = 0.0;
+		double y = 0.0;
+		double z = 0.0;
+		int count = 0;
+		int first = -1;
+	};
+
+	VoxelFrame frame_;  // Anchored at the first finite point added.
+	std::unordered_map<VoxelKey, int, VoxelKeyHash> slot_of_;
+	std::vector<Sum> sums_;
+	std::vector<VoxelKey> keys_;         // Cell of each slot, for the final (z, y, x) ordering.
+	PointAttributes first_attributes_;  // Row per slot: attributes of its first point.
+	std::vector<int> fresh_;            // Scratch: chunk rows that opened a voxel.
+	std::size_t seen_ = 0;
+};
+
+}  // namespace m2c
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "m2c/types.h"
+
+namespace m2c {
+
+// Integer coordinates of the cubic cell containing a point, counted from a frame's reference cell;
+// shared by the hashed voxel structures.
+struct VoxelKey {
+	std::int32_t x;
+	std::int32_t y;
+	std::int32_t z;
+
+	bool operator==(const VoxelKey& other) const {
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+struct VoxelKeyHash {
+	std::size_t operator()(const VoxelKey& k) const {
+		// Large primes from the classic spatial hashing scheme (Teschner et al.).
+		const std::uint64_t h = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(k.x)) * 73856093ULL) ^
+		                        (static_cast<std::uint64_t>(static_cast<std::uint32_t>(k.y)) * 19349663ULL) ^
+		                        (static_cast<std::uint64_t>(static_cast<std::uint32_t>(k.z)) * 83492791ULL);
+		return static_cast<std::size_t>(h);
+	}
+};
+
+// Absolute cell index along one axis, saturated to +-2^62 (0 for NaN) so the conversion is defined.
+inline std::int64_t voxelIndex(float v, float inv_cell) {
+	constexpr float kLimit = 4611686018427387904.0f;  // 2^62, exact in float.
+	const float cell = std::floor(v * inv_cell);
+	if (cell >= kLimit) return static_cast<std::int64_t>(kLimit);
+	if (cell <= -kLimit) return -static_cast<std::int64_t>(kLimit);
+	return cell == cell ? static_cast<std::int64_t>(cell) : 0;
+}
+
+// Grid with edge 1 / inv_cell anchored at the origin, keyed relative to the cell of a reference point.
+// Absolute indices overflow 32 bits for georeferenced (UTM-scale) coordinates over fine cells, while
+// offsets within one cloud do not; the rare offset beyond +-(2^31 - 2) cells saturates there, which
+// also keeps the +-1 neighbor arithmetic on keys in range.
+struct VoxelFrame {
+	float inv_cell;
+	std::int64_t x;
+	std::int64_t y;
+	std::int64_t z;
+};
+
+inline VoxelFrame voxelFrame(const PointT& reference, float inv_cell) {
+	return VoxelFrame{inv_cell, voxelIndex(reference.x, inv_cell), voxelIndex(reference.y, inv_cell),
+	                  voxelIndex(reference.z, inv_cell)};
+}
+
+inline std::int32_t voxelOffset(std::int64_t index, std::int64_t origin) {
+	constexpr std::int64_t kLimit = 2147483646;
+	return static_cast<std::int32_t>(std::min(std::max(index - origin, -kLimit), kLimit));
+}
+
+// Cell of `p` in `frame`.
+inline VoxelKey voxelKeyOf(const PointT& p, const VoxelFrame& frame) {
+	return VoxelKey{voxelOffset(voxelIndex(p.x, frame.inv_cell), frame.x),
+	                voxelOffset(voxelIndex(p.y, frame.inv_cell), frame.y),
+	                voxelOffset(voxelIndex(p.z, frame.inv_cell), frame.z)};
+}
+
+}  // namespace m2c
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "m2c/types.h"
+
+namespace m2c {
+
+// Approximate Euclidean clustering over occupied voxels of edge `cell`.
+// Points are bucketed into a hashed voxel set and voxels are joined through their 26 neighbors,
+// so no point-level radius search is issued. With cell >= eps every pair of points closer than
+// eps lands in the same or an adjacent voxel: components are a coarsening of the exact ones.
+// Output layout mirrors pcg::FEC (one PointIndices per component, original cloud indices).
+// `poll` (optional) is called periodically and may throw to cancel.
+std::vector<PointIndices> voxelConnectedComponents(const CloudT& cloud,
+                                                        float cell,
+                                                        const std::function<void()>& poll = {});
+
+}  // namespace m2c
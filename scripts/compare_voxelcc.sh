@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+# Report how often the voxel-connectivity preview agrees with full FEC on a set of scenes.
+# Usage: scripts/compare_voxelcc.sh <scene_dir> [cluster_probe flags...]
+# Each scene is a point cloud (<name>.las|.ply|.pcd) next to its pose (<name>.json).
+# A scene counts as agreeing when the IoU of the two selected clusters is >= AGREE_IOU (default 0.9).
+set -euo pipefail
+
+scene_dir=${1:?scene directory required}
+shift
+probe=${CLUSTER_PROBE:-./build/cluster_probe}
+threshold=${AGREE_IOU:-0.9}
+
+total=0
+agree=0
+for cloud in "${scene_dir}"/*.las "${scene_dir}"/*.ply "${scene_dir}"/*.pcd; do
+	[ -e "${cloud}" ] || continue
+	pose="${cloud%.*}.json"
+	[ -e "${pose}" ] || continue
+	out=$("${probe}" --in "${cloud}" --pose "${pose}" "$@")
+	iou=$(printf '%s\n' "${out}" | awk -F: '/Agreement/ {gsub(/ /, "", $2); print $2}')
+	printf '%s\tIoU=%s\n' "$(basename "${cloud}")" "${iou}"
+	total=$((total + 1))
+	if awk -v v="${iou}" -v t="${threshold}" 'BEGIN {exit !(v >= t)}'; then
+		agree=$((agree + 1))
+	fi
+done
+
+echo "Agreement: ${agree}/${total} scenes (IoU >= ${threshold})"
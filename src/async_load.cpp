@@ -0,0 +1,223 @@
+#include "m2c/async_load.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "m2c/io_las.h"
+#include "m2c/trace.h"
+#include "m2c/voxel_grid.h"
+
+namespace m2c {
+namespace {
+
+// Thrown from the reader callback to unwind forEachPointChunk when the consumer went away.
+struct StreamCancelled {};
+
+LoadedCloud loadJob(const std::string& path, const LoadOptions& options,
+                    const std::shared_ptr<const std::atomic<bool>>& cancel) {
+  M2C_TRACE_SCOPE("loadAsync");
+  LoadedCloud loaded;
+  PointAttributes* attributes = options.attributes ? &loaded.attributes : nullptr;
+  loaded.attributes.scan_order = options.scan_order;
+  const bool keep_input = options.keep_input || !(options.voxel > 0.0f);
+
+  if (options.roi.radius > 0.0f) {
+    // ROI loads read only the cells around C; little left to overlap, so load then voxelize.
+    loaded.cloud = loadAnyPointCloud(path, &options.roi, attributes);
+    loaded.input_points = loaded.cloud->size();
+    if (options.frustum) {
+      loaded.culled_points = options.frustum->cull(*loaded.cloud, attributes);
+    }
+    if (options.voxel > 0.0f) {
+      loaded.voxelized = voxelFilter(loaded.cloud, options.voxel, &loaded.first_source);
+    }
+    if (!keep_input) {
+      loaded.cloud.reset();
+      if (attributes && !attributes->empty()) {
+        *attributes = attributes->select(loaded.first_source);
+      }
+    }
+    return loaded;
+  }
+
+  std::unique_ptr<VoxelAccumulator> voxels;
+  if (options.voxel > 0.0f) {
+    voxels.reset(new VoxelAccumulator(options.voxel));
+  }
+  if (keep_input) {
+    loaded.cloud.reset(new CloudT);
+    // Size the cloud once: growing it here would leave its discarded buffers in this thread's
+    // malloc arena, where the caller's clustering cannot reuse them. A frustum keeps an unknown
+    // share, so that cloud grows instead (the trim below returns the slack).
+    if (!options.frustum) {
+      loaded.cloud->points.reserve(pointCountHint(path));
+    }
+  }
+  PointChunkStream stream(path, options.chunk_points, options.read_ahead, options.attributes, options.scan_order);
+  CloudT chunk;
+  PointAttributes chunk_attributes;
+  while (stream.next(chunk, attributes ? &chunk_attributes : nullptr)) {
+    if (cancel && cancel->load(std::memory_order_relaxed)) {
+      return LoadedCloud();  // Nobody waits for the result; the stream stops its reader on return.
+    }
+    loaded.input_points += chunk.size();
+    if (options.frustum) {
+      loaded.culled_points += options.frustum->cull(chunk, attributes ? &chunk_attributes : nullptr);
+    }
+    if (voxels) {
+      // Without the input, the accumulator keeps each voxel's first attribute row itself.
+      voxels->add(chunk, keep_input || !attributes ? nullptr : &chunk_attributes);
+    }
+    if (keep_input) {
+      loaded.cloud->points.insert(loaded.cloud->points.end(), chunk.points.begin(), chunk.points.end());
+      if (attributes) {
+        attributes->append(chunk_attributes);
+      }
+    }
+  }
+  if (keep_input) {
+    loaded.cloud->width = static_cast<std::uint32_t>(loaded.cloud->size());
+    loaded.cloud->height = 1;
+    loaded.cloud->is_dense = false;
+  }
+  if (voxels) {
+    loaded.voxelized = voxels->finish(&loaded.first_source, keep_input || !attributes ? nullptr : attributes);
+    voxels.reset();
+  }
+#ifdef __GLIBC__
+  // The voxel cell map and the column growth buffers were freed into this thread's arena; return
+  // those pages rather than keep them resident while the caller clusters.
+  if (options.trim_heap) {
+    malloc_trim(0);
+  }
+#endif
+  return loaded;
+}
+
+}  // namespace
+
+struct PointChunkStream::State {
+  struct Item {
+    CloudT chunk;
+    PointAttributes attributes;
+  };
+
+  std::mutex mutex;
+  std::condition_variable ready;  // signalled when an item arrives or the reader finishes
+  std::condition_variable space;  // signalled when the consumer takes an item or cancels
+  std::deque<Item> queue;
+  std::size_t capacity = 1;
+  bool finished = false;
+  bool cancelled = false;
+  std::exception_ptr error;
+};
+
+PointChunkStream::PointChunkStream(const std::string& path,
+                                   std::size_t chunk_points,
+                                   std::size_t read_ahead,
+                                   bool attributes,
+                                   bool scan_order)
+    : state_(std::make_shared<State>()) {
+  state_->capacity = std::max<std::size_t>(1, read_ahead);
+  std::shared_ptr<State> state = state_;
+  reader_ = std::thread([state, path, chunk_points, attributes, scan_order]() {
+    PointAttributes chunk_attributes;
+    chunk_attributes.scan_order = scan_order;
+    try {
+      forEachPointChunk(
+          path, chunk_points,
+          [&](const CloudT& chunk) {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->space.wait(lock, [&] { return state->cancelled || state->queue.size() < state->capacity; });
+            if (state->cancelled) {
+              throw StreamCancelled();
+            }
+            state->queue.push_back({chunk, attributes ? chunk_attributes : PointAttributes()});
+            state->ready.notify_one();
+          },
+          attributes ? &chunk_attributes : nullptr);
+    } catch (const StreamCancelled&) {
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->error = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->finished = true;
+    state->ready.notify_all();
+  });
+}
+
+PointChunkStream::~PointChunkStream() {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->cancelled = true;
+  }
+  state_->space.notify_all();
+  if (reader_.joinable()) {
+    reader_.join();
+  }
+}
+
+bool PointChunkStream::next(CloudT& chunk, PointAttributes* attributes) {
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  state_->ready.wait(lock, [&] { return !state_->queue.empty() || state_->finished; });
+  if (state_->queue.empty()) {
+    if (state_->error) {
+      std::rethrow_exception(state_->error);
+    }
+    return false;
+  }
+  State::Item item = std::move(state_->queue.front());
+  state_->queue.pop_front();
+  lock.unlock();
+  state_->space.notify_one();
+  chunk = std::move(item.chunk);
+  if (attributes) {
+    *attributes = std::move(item.attributes);
+  }
+  return true;
+}
+
+std::future<LoadedCloud> loadAnyPointCloudAsync(const std::string& path, const LoadOptions& options,
+                                                std::shared_ptr<const std::atomic<bool>> cancel) {
+  return std::async(std::launch::async, loadJob, path, options, std::move(cancel));
+}
+
+CloudPrefetcher::CloudPrefetcher(std::vector<LoadRequest> requests, std::size_t depth)
+    : requests_(std::move(requests)), depth_(std::max<std::size_t>(1, depth)) {
+  refill();
+}
+
+CloudPrefetcher::~CloudPrefetcher() {
+  // The pending futures' destructors wait for their loads; make those stop early.
+  cancel_->store(true, std::memory_order_relaxed);
+}
+
+void CloudPrefetcher::refill() {
+  while (scheduled_ < requests_.size() && pending_.size() < depth_) {
+    const LoadRequest& request = requests_[scheduled_++];
+    pending_.push_back(loadAnyPointCloudAsync(request.path, request.options, cancel_));
+  }
+}
+
+LoadedCloud CloudPrefetcher::next() {
+  if (done()) {
+    throw std::out_of_range("CloudPrefetcher has no more inputs");
+  }
+  std::future<LoadedCloud> front = std::move(pending_.front());
+  pending_.pop_front();
+  ++next_;
+  // Start the next load before blocking, so the window stays full while the caller works.
+  refill();
+  return front.get();
+}
+
+}  // namespace m2c
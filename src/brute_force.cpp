@@ -0,0 +1,230 @@
+#include "m2c/brute_force.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "m2c/kdtree.h"
+
+namespace m2c {
+namespace {
+
+constexpr std::size_t kTile = BruteForceIndex::kTile;
+
+bool isFinite(const PointT& p) {
+  return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+}
+
+// Spreads the low 10 bits of v so that two zero bits follow each one (3D Morton interleave).
+std::uint32_t spreadBits(std::uint32_t v) {
+  v &= 0x3FF;
+  v = (v | (v << 16)) & 0x030000FF;
+  v = (v | (v << 8)) & 0x0300F00F;
+  v = (v | (v << 4)) & 0x030C30C3;
+  v = (v | (v << 2)) & 0x09249249;
+  return v;
+}
+
+}  // namespace
+
+BruteForceIndex::BruteForceIndex(const CloudT& cloud) : cloud_size_(cloud.size()) {
+  float lo[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                 std::numeric_limits<float>::max()};
+  float hi[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                 std::numeric_limits<float>::lowest()};
+  ids_.reserve(cloud.size());
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    const PointT& p = cloud[i];
+    if (!isFinite(p)) continue;
+    ids_.push_back(static_cast<int>(i));
+    const float c[3] = {p.x, p.y, p.z};
+    for (int axis = 0; axis < 3; ++axis) {
+      lo[axis] = std::min(lo[axis], c[axis]);
+      hi[axis] = std::max(hi[axis], c[axis]);
+    }
+  }
+
+  // Morton order keeps each tile spatially compact, so most tiles fail the box test of a query.
+  if (ids_.size() > kTile) {
+    std::vector<std::pair<std::uint32_t, int>> keyed;
+    keyed.reserve(ids_.size());
+    float scale[3];
+    for (int axis = 0; axis < 3; ++axis) {
+      scale[axis] = hi[axis] > lo[axis] ? 1023.0f / (hi[axis] - lo[axis]) : 0.0f;
+    }
+    for (int id : ids_) {
+      const PointT& p = cloud[static_cast<std::size_t>(id)];
+      const float c[3] = {p.x, p.y, p.z};
+      std::uint32_t key = 0;
+      for (int axis = 0; axis < 3; ++axis) {
+        key |= spreadBits(static_cast<std::uint32_t>((c[axis] - lo[axis]) * scale[axis])) << axis;
+      }
+      keyed.emplace_back(key, id);
+    }
+    std::sort(keyed.begin(), keyed.end());
+    for (std::size_t k = 0; k < keyed.size(); ++k) ids_[k] = keyed[k].second;
+  }
+
+  const std::size_t tiles = (ids_.size() + kTile - 1) / kTile;
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  x_.assign(tiles * kTile, nan);  // Padding keeps the distance loop at a fixed trip count.
+  y_.assign(tiles * kTile, nan);
+  z_.assign(tiles * kTile, nan);
+  boxes_.resize(tiles);
+  for (std::size_t t = 0; t < tiles; ++t) {
+    Box& box = boxes_[t];
+    for (int axis = 0; axis < 3; ++axis) {
+      box.lo[axis] = std::numeric_limits<float>::max();
+      box.hi[axis] = std::numeric_limits<float>::lowest();
+    }
+    for (std::size_t k = t * kTile; k < std::min(ids_.size(), (t + 1) * kTile); ++k) {
+      const PointT& p = cloud[static_cast<std::size_t>(ids_[k])];
+      x_[k] = p.x;
+      y_[k] = p.y;
+      z_[k] = p.z;
+      const float c[3] = {p.x, p.y, p.z};
+      for (int axis = 0; axis < 3; ++axis) {
+        box.lo[axis] = std::min(box.lo[axis], c[axis]);
+        box.hi[axis] = std::max(box.hi[axis], c[axis]);
+      }
+    }
+  }
+}
+
+int BruteForceIndex::tileDistances(const PointT& query, std::size_t t, float r2, float* d2) const {
+  const float* x = x_.data() + t * kTile;
+  const float* y = y_.data() + t * kTile;
+  const float* z = z_.data() + t * kTile;
+  const float qx = query.x, qy = query.y, qz = query.z;
+  int within = 0;
+  for (std::size_t i = 0; i < kTile; ++i) {
+    const float dx = x[i] - qx;
+    const float dy = y[i] - qy;
+    const float dz = z[i] - qz;
+    d2[i] = dx * dx + dy * dy + dz * dz;
+    within += d2[i] <= r2;
+  }
+  return within;
+}
+
+void BruteForceIndex::radius(const PointT& query, float r, std::vector<int>& out, int max_nn,
+                             std::vector<float>* sqr_distances) const {
+  out.clear();
+  if (sqr_distances) {
+    sqr_distances->clear();
+  }
+  if (!(r > 0.0f) || !isFinite(query)) {
+    return;
+  }
+  const float r2 = r * r;
+  thread_local std::vector<std::pair<float, int>> hits;
+  hits.clear();
+  float d2[kTile];
+  for (std::size_t t = 0; t < boxes_.size(); ++t) {
+    if (boxes_[t].distance2(query) > r2 || tileDistances(query, t, r2, d2) == 0) {
+      continue;  // The common case at FEC radii: skip the scan.
+    }
+    const std::size_t valid = std::min(kTile, ids_.size() - t * kTile);  // padding is at the end
+    const int* ids = ids_.data() + t * kTile;
+    for (std::size_t i = 0; i < valid; ++i) {
+      if (d2[i] <= r2) {
+        hits.emplace_back(d2[i], ids[i]);
+      }
+    }
+  }
+
+  // Same contract as PCL's sorted radiusSearch: nearest first, optionally truncated.
+  std::size_t keep = hits.size();
+  if (max_nn > 0 && static_cast<std::size_t>(max_nn) < keep) {
+    keep = static_cast<std::size_t>(max_nn);
+    std::partial_sort(hits.begin(), hits.begin() + static_cast<std::ptrdiff_t>(keep), hits.end());
+  } else {
+    std::sort(hits.begin(), hits.end());
+  }
+  out.reserve(keep);
+  for (std::size_t i = 0; i < keep; ++i) {
+    out.push_back(hits[i].second);
+    if (sqr_distances) {
+      sqr_distances->push_back(hits[i].first);
+    }
+  }
+}
+
+void BruteForceIndex::knn(const PointT& query, int k, std::vector<int>& out, std::vector<float>* sqr_distances) const {
+  out.clear();
+  if (sqr_distances) {
+    sqr_distances->clear();
+  }
+  if (k <= 0 || !isFinite(query)) {
+    return;
+  }
+  const std::size_t cap = static_cast<std::size_t>(k);
+  thread_local std::vector<std::pair<float, int>> best;  // max-heap on distance, at most k entries
+  best.clear();
+  float d2[kTile];
+  for (std::size_t t = 0; t < boxes_.size(); ++t) {
+    if (best.size() == cap && boxes_[t].distance2(query) > best.front().first) {
+      continue;
+    }
+    tileDistances(query, t, std::numeric_limits<float>::infinity(), d2);
+    const std::size_t valid = std::min(kTile, ids_.size() - t * kTile);  // padding is at the end
+    const int* ids = ids_.data() + t * kTile;
+    for (std::size_t i = 0; i < valid; ++i) {
+      const std::pair<float, int> hit(d2[i], ids[i]);
+      if (best.size() < cap) {
+        best.push_back(hit);
+        std::push_heap(best.begin(), best.end());
+      } else if (hit < best.front()) {  // ties at the k-th distance go to the lower index
+        std::pop_heap(best.begin(), best.end());
+        best.back() = hit;
+        std::push_heap(best.begin(), best.end());
+      }
+    }
+  }
+
+  std::sort_heap(best.begin(), best.end());
+  out.reserve(best.size());
+  for (const auto& hit : best) {
+    out.push_back(hit.second);
+    if (sqr_distances) {
+      sqr_distances->push_back(hit.first);
+    }
+  }
+}
+
+SearchBackend chooseSearchBackend(const CloudT& cloud, const KDOptions& options) {
+  if (options.backend != SearchBackend::Auto) {
+    return options.backend;
+  }
+  if (cloud.size() <= options.brute_force_max_points) {
+    return SearchBackend::BruteForce;
+  }
+  if (options.radius_hint <= 0.0f || cloud.size() > options.compact_max_points) {
+    return SearchBackend::Tree;
+  }
+  float lo[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                 std::numeric_limits<float>::max()};
+  float hi[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                 std::numeric_limits<float>::lowest()};
+  for (const PointT& p : cloud) {
+    if (!isFinite(p)) continue;
+    const float c[3] = {p.x, p.y, p.z};
+    for (int axis = 0; axis < 3; ++axis) {
+      lo[axis] = std::min(lo[axis], c[axis]);
+      hi[axis] = std::max(hi[axis], c[axis]);
+    }
+  }
+  float coverage = 1.0f;
+  for (int axis = 0; axis < 3; ++axis) {
+    const float extent = hi[axis] - lo[axis];
+    if (extent > 2.0f * options.radius_hint) {
+      coverage *= 2.0f * options.radius_hint / extent;
+    }
+  }
+  return coverage >= options.brute_force_min_coverage ? SearchBackend::BruteForce : SearchBackend::Tree;
+}
+
+}  // namespace m2c
@@ -0,0 +1,146 @@
+#include "m2c/cluster_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "m2c/trace.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace m2c {
+namespace {
+
+// Running sums for one cluster; converted to ClusterStats once all partials are merged.
+struct Accumulator {
+  std::int64_t count = 0;
+  Eigen::Vector3f min = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  Eigen::Vector3f max = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+  Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+  float nearest_sq = std::numeric_limits<float>::infinity();
+
+  void add(const Eigen::Vector3f& p, const Eigen::Vector3f& C) {
+    ++count;
+    min = min.cwiseMin(p);
+    max = max.cwiseMax(p);
+    sum += p.cast<double>();
+    nearest_sq = std::min(nearest_sq, (p - C).squaredNorm());
+  }
+
+  void merge(const Accumulator& other) {
+    count += other.count;
+    min = min.cwiseMin(other.min);
+    max = max.cwiseMax(other.max);
+    sum += other.sum;
+    nearest_sq = std::min(nearest_sq, other.nearest_sq);
+  }
+};
+
+// Accumulators for the contiguous cluster id range [first, first + acc.size()).
+struct Partial {
+  std::size_t first = 0;
+  std::vector<Accumulator> acc;
+};
+
+}  // namespace
+
+float ClusterStats::diameter() const {
+  if (count <= 0) {
+    return 0.0f;
+  }
+  return (max - min).norm();
+}
+
+float ClusterStats::farthestBound(const Eigen::Vector3f& C) const {
+  if (count <= 0) {
+    return std::numeric_limits<float>::infinity();
+  }
+  const Eigen::Vector3f far = (C - min).cwiseAbs().cwiseMax((max - C).cwiseAbs());
+  return far.norm();
+}
+
+std::vector<ClusterStats> labelClusters(const CloudT& cloud,
+                                        const std::vector<PointIndices>& clusters,
+                                        const Eigen::Vector3f& C,
+                                        std::vector<int>& labels) {
+  M2C_TRACE_SCOPE("labelClusters");
+  labels.assign(cloud.size(), -1);
+  std::vector<ClusterStats> stats(clusters.size());
+  if (clusters.empty()) {
+    return stats;
+  }
+
+  // offsets[k] = position of cluster k's first member in the cluster-major sweep.
+  std::vector<std::size_t> offsets(clusters.size() + 1, 0);
+  for (std::size_t k = 0; k < clusters.size(); ++k) {
+    offsets[k + 1] = offsets[k] + clusters[k].indices.size();
+  }
+  const std::size_t total = offsets.back();
+
+  int threads = 1;
+#ifdef _OPENMP
+  threads = std::max(1, std::min<int>(omp_get_max_threads(), static_cast<int>(total / 4096 + 1)));
+#endif
+  std::vector<Partial> partials(static_cast<std::size_t>(threads));
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threads)
+#endif
+  {
+    M2C_TRACE_SCOPE("labelClusters.worker");
+    int t = 0;
+#ifdef _OPENMP
+    t = omp_get_thread_num();
+#endif
+    const std::size_t begin = total * static_cast<std::size_t>(t) / static_cast<std::size_t>(threads);
+    const std::size_t end = total * static_cast<std::size_t>(t + 1) / static_cast<std::size_t>(threads);
+    Partial& part = partials[static_cast<std::size_t>(t)];
+
+    if (begin < end) {
+      std::size_t k = static_cast<std::size_t>(std::upper_bound(offsets.begin(), offsets.end(), begin) - offsets.begin()) - 1;
+      part.first = k;
+      std::size_t pos = begin;
+      while (pos < end) {
+        const std::vector<int>& members = clusters[k].indices;
+        const std::size_t stop = std::min(end, offsets[k + 1]);
+        part.acc.emplace_back();
+        Accumulator& acc = part.acc.back();
+        for (; pos < stop; ++pos) {
+          const int idx = members[pos - offsets[k]];
+          if (idx < 0 || static_cast<std::size_t>(idx) >= cloud.size()) continue;
+          labels[static_cast<std::size_t>(idx)] = static_cast<int>(k);
+          const PointT& p = cloud[static_cast<std::size_t>(idx)];
+          acc.add(Eigen::Vector3f(p.x, p.y, p.z), C);
+        }
+        ++k;
+      }
+    }
+  }
+
+  // Merge: thread ranges are disjoint except where a cluster straddles a split point.
+  std::vector<Accumulator> merged(clusters.size());
+  for (const Partial& part : partials) {
+    for (std::size_t j = 0; j < part.acc.size(); ++j) {
+      merged[part.first + j].merge(part.acc[j]);
+    }
+  }
+
+  for (std::size_t k = 0; k < clusters.size(); ++k) {
+    const Accumulator& acc = merged[k];
+    ClusterStats& s = stats[k];
+    s.count = static_cast<int>(acc.count);
+    if (acc.count == 0) {
+      continue;
+    }
+    s.min = acc.min;
+    s.max = acc.max;
+    s.centroid = (acc.sum / static_cast<double>(acc.count)).cast<float>();
+    s.nearest = std::sqrt(acc.nearest_sq);
+  }
+  return stats;
+}
+
+}  // namespace m2c
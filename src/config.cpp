@@ -0,0 +1,177 @@
+#include "m2c/config.h"
+
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "m2c/kdtree.h"
+
+namespace m2c {
+namespace {
+
+std::string trimCopy(const std::string& s) {
+  const auto start = s.find_first_not_of(" \t\r\n");
+  if (start == std::string::npos) {
+    return std::string();
+  }
+  const auto end = s.find_last_not_of(" \t\r\n");
+  return s.substr(start, end - start + 1);
+}
+
+float parseScalar(const std::string& key, const std::string& value) {
+  try {
+    return std::stof(value);
+  } catch (const std::exception&) {
+    throw std::runtime_error("Invalid numeric value for '" + key + "': " + value);
+  }
+}
+
+}  // namespace
+
+ClusterAlgo parseAlgo(const std::string& value) {
+  if (value == "fec") {
+    return ClusterAlgo::FEC;
+  }
+  if (value == "voxelcc") {
+    return ClusterAlgo::VoxelCC;
+  }
+  throw std::runtime_error("Unknown clustering algorithm: " + value + " (expected fec or voxelcc)");
+}
+
+CameraAxes parseCameraAxes(const std::string& value) {
+  if (value == "flu") {
+    return CameraAxes::ForwardLeftUp;
+  }
+  if (value == "opencv") {
+    return CameraAxes::OpenCV;
+  }
+  if (value == "opengl") {
+    return CameraAxes::OpenGL;
+  }
+  throw std::runtime_error("Unknown camera axes: " + value + " (expected flu, opencv or opengl)");
+}
+
+Params defaultParams() {
+  Params params{};
+  params.eps = 0.35f;
+  params.eps_auto = false;
+  params.minPts_core = 8;
+  params.minPts_total = 60; // This line remains unchanged
+  params.maxDiameter = 1.5f;
+  params.maxPts = 500000;
+  params.max_trials = 100;
+  params.voxel = 0.05f;
+  params.n = 0.25f; // New parameter
+  params.m = 100;   // New parameter
+  params.algo = ClusterAlgo::FEC;
+  params.refine = false;
+  params.deadline = 0.0f;  // no latency budget
+  params.frustum = false;  // translation-only selection
+  params.fov_h = 90.0f;
+  params.fov_v = 60.0f;
+  params.near_clip = 0.1f;
+  params.far_clip = 0.0f;
+  params.camera_axes = CameraAxes::ForwardLeftUp;
+  params.organized = false;  // unordered input: spatial index only
+  const KDOptions kd_defaults;  // compiled crossovers
+  params.kd_brute_force_max_points = static_cast<int>(kd_defaults.brute_force_max_points);
+  params.kd_brute_force_min_coverage = kd_defaults.brute_force_min_coverage;
+  params.kd_compact_max_points = static_cast<int>(kd_defaults.compact_max_points);
+  return params;
+}
+
+void applyYamlConfig(const std::string& path, Params& params) {
+  if (path.empty()) {
+    return;
+  }
+
+  std::ifstream input(path);
+  if (!input) {
+    throw std::runtime_error("Failed to open config file: " + path);
+  }
+
+  std::string line;
+  bool inCluster = false;
+
+  while (std::getline(input, line)) {
+    const std::string trimmed = trimCopy(line);
+    if (trimmed.empty() || trimmed[0] == '#') {
+      continue;
+    }
+
+    const bool topLevel = !line.empty() && !std::isspace(static_cast<unsigned char>(line[0]));
+    if (topLevel && trimmed.back() == ':') {
+      inCluster = trimmed == "cluster:";
+      continue;
+    }
+
+    if (!inCluster) {
+      continue;
+    }
+
+    const auto colonPos = trimmed.find(':');
+    if (colonPos == std::string::npos) {
+      continue;
+    }
+
+    std::string key = trimCopy(trimmed.substr(0, colonPos));
+    std::string value = trimCopy(trimmed.substr(colonPos + 1));
+
+    const auto commentPos = value.find('#');
+    if (commentPos != std::string::npos) {
+      value = trimCopy(value.substr(0, commentPos));
+    }
+
+    if (value.empty()) {
+      continue;
+    }
+
+    if (key == "eps") {
+      params.eps_auto = value == "auto";
+      if (!params.eps_auto) {
+        params.eps = parseScalar(key, value);
+      }
+    } else if (key == "minPts_core") {
+      params.minPts_core = static_cast<int>(parseScalar(key, value));
+    } else if (key == "minPts_total") {
+      params.minPts_total = static_cast<int>(parseScalar(key, value));
+    } else if (key == "maxDiameter") {
+      params.maxDiameter = parseScalar(key, value);
+    } else if (key == "maxPts") {
+      params.maxPts = static_cast<int>(parseScalar(key, value));
+    } else if (key == "max_trials") {
+      params.max_trials = static_cast<int>(parseScalar(key, value));
+    } else if (key == "voxel") {
+      params.voxel = parseScalar(key, value);
+    } else if (key == "algo") {
+      params.algo = parseAlgo(value);
+    } else if (key == "refine") {
+      params.refine = value == "true" || value == "1";
+    } else if (key == "deadline_ms") {
+      params.deadline = parseScalar(key, value);
+    } else if (key == "frustum") {
+      params.frustum = value == "true" || value == "1";
+    } else if (key == "fov_h") {
+      params.fov_h = parseScalar(key, value);
+    } else if (key == "fov_v") {
+      params.fov_v = parseScalar(key, value);
+    } else if (key == "near") {
+      params.near_clip = parseScalar(key, value);
+    } else if (key == "far") {
+      params.far_clip = parseScalar(key, value);
+    } else if (key == "camera_axes") {
+      params.camera_axes = parseCameraAxes(value);
+    } else if (key == "organized") {
+      params.organized = value == "true" || value == "1";
+    } else if (key == "kd_brute_force_max_points") {
+      params.kd_brute_force_max_points = static_cast<int>(parseScalar(key, value));
+    } else if (key == "kd_brute_force_min_coverage") {
+      params.kd_brute_force_min_coverage = parseScalar(key, value);
+    } else if (key == "kd_compact_max_points") {
+      params.kd_compact_max_points = static_cast<int>(parseScalar(key, value));
+    }
+  }
+}
+
+}  // namespace m2c
@@ -0,0 +1,86 @@
+#include "m2c/dbscan_seeded.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace m2c {
+
+Cluster growFromSeed_DBSCAN(int seed_idx,
+                            const CloudT& cloud,
+                            const KD& kd,
+                            float eps,
+                            int minPts_core,
+                            int maxPts,
+                            float maxDiameter,
+                            const std::function<void()>& poll) {
+  if (seed_idx < 0 || static_cast<std::size_t>(seed_idx) >= cloud.size()) {
+    throw std::out_of_range("Seed index out of bounds");
+  }
+
+  Cluster cluster;
+  std::vector<char> member(cloud.size(), 0);
+  std::vector<int> neighbors;
+  neighbors.reserve(64);
+
+  float min_x = std::numeric_limits<float>::max();
+  float min_y = std::numeric_limits<float>::max();
+  float min_z = std::numeric_limits<float>::max();
+  float max_x = std::numeric_limits<float>::lowest();
+  float max_y = std::numeric_limits<float>::lowest();
+  float max_z = std::numeric_limits<float>::lowest();
+
+  auto admit = [&](int idx) {
+    member[idx] = 1;
+    cluster.indices.push_back(idx);
+    const PointT& p = cloud[idx];
+    min_x = std::min(min_x, p.x); max_x = std::max(max_x, p.x);
+    min_y = std::min(min_y, p.y); max_y = std::max(max_y, p.y);
+    min_z = std::min(min_z, p.z); max_z = std::max(max_z, p.z);
+    const float dx = max_x - min_x;
+    const float dy = max_y - min_y;
+    const float dz = max_z - min_z;
+    cluster.diameter = std::sqrt(dx * dx + dy * dy + dz * dz);
+  };
+
+  admit(seed_idx);
+  std::deque<int> frontier{seed_idx};
+
+  std::size_t expanded = 0;
+  while (!frontier.empty()) {
+    if (poll && (++expanded & 63u) == 0) {
+      poll();
+    }
+    const int idx = frontier.front();
+    frontier.pop_front();
+
+    kd.radius(idx, eps, neighbors);
+    if (static_cast<int>(neighbors.size()) < minPts_core) {
+      continue;  // boundary point: joins the cluster but does not expand it
+    }
+
+    for (int nb : neighbors) {
+      if (member[nb]) {
+        continue;
+      }
+      admit(nb);
+      frontier.push_back(nb);
+
+      // Stop early once the cluster can no longer pass validation or hits the safety cap.
+      if (maxPts > 0 && static_cast<int>(cluster.indices.size()) >= maxPts) {
+        cluster.truncated = true;
+        return cluster;
+      }
+      if (maxDiameter > 0.0f && cluster.diameter > maxDiameter) {
+        return cluster;
+      }
+    }
+  }
+
+  return cluster;
+}
+
+}  // namespace m2c
@@ -0,0 +1,59 @@
+#include "m2c/deadline.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace m2c {
+
+Deadline::Deadline() : start_(Clock::now()), end_(start_), unlimited_(true) {}
+
+Deadline::Deadline(double budget_ms) : start_(Clock::now()), end_(start_), unlimited_(budget_ms <= 0.0) {
+  if (!unlimited_) {
+    end_ = start_ + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(budget_ms));
+  }
+}
+
+bool Deadline::expired() const {
+  return !unlimited_ && Clock::now() >= end_;
+}
+
+void Deadline::check() const {
+  if (expired()) {
+    throw DeadlineExceeded();
+  }
+}
+
+double Deadline::elapsedMs() const {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start_).count();
+}
+
+double Deadline::remainingMs() const {
+  if (unlimited_) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return std::max(0.0, std::chrono::duration<double, std::milli>(end_ - Clock::now()).count());
+}
+
+Deadline Deadline::slice(double fraction) const {
+  if (unlimited_) {
+    return *this;
+  }
+  Deadline child = *this;
+  const auto total = end_ - start_;
+  const auto cut = start_ + std::chrono::duration_cast<Clock::duration>(total * std::clamp(fraction, 0.0, 1.0));
+  child.end_ = std::min(end_, cut);
+  return child;
+}
+
+Deadline Deadline::atLeast(double min_ms) const {
+  if (unlimited_) {
+    return *this;
+  }
+  Deadline child = *this;
+  const auto floor = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                        std::chrono::duration<double, std::milli>(std::max(0.0, min_ms)));
+  child.end_ = std::max(end_, floor);
+  return child;
+}
+
+}  // namespace m2c
@@ -0,0 +1,116 @@
+#include "m2c/eps_estimate.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "m2c/quantile_sketch.h"
+#include "m2c/trace.h"
+
+namespace m2c {
+namespace {
+
+constexpr double kSketchAccuracy = 0.005;
+constexpr double kLowQuantile = 0.01;
+constexpr double kHighQuantile = 0.99;
+constexpr int kCurveSteps = 98;
+
+}  // namespace
+
+EpsEstimate estimateEps(const CloudT& cloud, const KD& kd, int k, std::size_t max_samples,
+                        const std::function<void()>& poll) {
+  M2C_TRACE_SCOPE("estimateEps");
+  k = std::max(1, k);
+  if (cloud.size() <= static_cast<std::size_t>(k)) {
+    throw std::runtime_error("Cannot estimate eps: the cloud has no more points than minPts_core");
+  }
+  const std::size_t samples = std::max<std::size_t>(1, std::min(max_samples, cloud.size()));
+
+  int threads = 1;
+#ifdef _OPENMP
+  threads = std::max(1, std::min<int>(omp_get_max_threads(), static_cast<int>(samples / 256 + 1)));
+#endif
+  std::vector<QuantileSketch> sketches(static_cast<std::size_t>(threads), QuantileSketch(kSketchAccuracy));
+  // Exceptions cannot leave the parallel region: thread 0 polls and records a cancellation, and
+  // every thread stops at its next check.
+  std::atomic<bool> cancelled{false};
+  std::exception_ptr failure;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threads)
+#endif
+  {
+    int t = 0;
+#ifdef _OPENMP
+    t = omp_get_thread_num();
+#endif
+    QuantileSketch& sketch = sketches[static_cast<std::size_t>(t)];
+    std::vector<int> neighbors;
+    std::vector<float> sqr_distances;
+    const std::size_t begin = samples * static_cast<std::size_t>(t) / static_cast<std::size_t>(threads);
+    const std::size_t end = samples * static_cast<std::size_t>(t + 1) / static_cast<std::size_t>(threads);
+    for (std::size_t s = begin; s < end; ++s) {
+      if (poll && ((s - begin) & 63u) == 0) {
+        if (t == 0) {
+          try {
+            poll();
+          } catch (...) {
+            failure = std::current_exception();
+            cancelled.store(true, std::memory_order_relaxed);
+          }
+        }
+        if (cancelled.load(std::memory_order_relaxed)) break;
+      }
+      // Even stride over the cloud; the query point itself is neighbor 0.
+      const int idx = static_cast<int>(s * cloud.size() / samples);
+      kd.knn(idx, k + 1, neighbors, &sqr_distances);
+      if (sqr_distances.size() == static_cast<std::size_t>(k + 1)) {
+        sketch.add(std::sqrt(static_cast<double>(sqr_distances.back())));
+      }
+    }
+  }
+  if (failure) std::rethrow_exception(failure);
+  for (std::size_t t = 1; t < sketches.size(); ++t) {
+    sketches[0].merge(sketches[t]);
+  }
+  const QuantileSketch& sketch = sketches[0];
+
+  const double lo = sketch.quantile(kLowQuantile);
+  const double hi = sketch.quantile(kHighQuantile);
+  if (!(hi > 0.0)) {
+    throw std::runtime_error("Cannot estimate eps: sampled k-distances are all zero (duplicate points?)");
+  }
+
+  EpsEstimate estimate;
+  estimate.k = k;
+  estimate.samples = static_cast<std::size_t>(sketch.count());
+  estimate.eps = static_cast<float>(hi);
+  estimate.knee_quantile = static_cast<float>(kHighQuantile);
+  if (hi > lo) {
+    // Knee of the convex, ascending k-distance curve: farthest point below the normalized chord.
+    double best_gap = -1.0;
+    for (int step = 0; step <= kCurveSteps; ++step) {
+      const double q = kLowQuantile + (kHighQuantile - kLowQuantile) * step / kCurveSteps;
+      const double d = sketch.quantile(q);
+      const double gap = static_cast<double>(step) / kCurveSteps - (d - lo) / (hi - lo);
+      if (gap > best_gap) {
+        best_gap = gap;
+        estimate.eps = static_cast<float>(d);
+        estimate.knee_quantile = static_cast<float>(q);
+      }
+    }
+  }
+  if (!(estimate.eps > 0.0f)) {
+    estimate.eps = static_cast<float>(hi);
+  }
+  return estimate;
+}
+
+}  // namespace m2c
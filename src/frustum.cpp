@@ -0,0 +1,135 @@
+#include "m2c/frustum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "m2c/trace.h"
+
+namespace m2c {
+
+namespace {
+
+// Forward, left and up, in camera coordinates, for a camera axis convention.
+Eigen::Matrix3f cameraBasis(CameraAxes axes) {
+  Eigen::Matrix3f basis;
+  switch (axes) {
+    case CameraAxes::OpenCV:
+      basis << 0.0f, -1.0f, 0.0f,
+               0.0f, 0.0f, -1.0f,
+               1.0f, 0.0f, 0.0f;
+      return basis;
+    case CameraAxes::OpenGL:
+      basis << 0.0f, -1.0f, 0.0f,
+               0.0f, 0.0f, 1.0f,
+               -1.0f, 0.0f, 0.0f;
+      return basis;
+    case CameraAxes::ForwardLeftUp:
+      break;
+  }
+  return Eigen::Matrix3f::Identity();
+}
+
+}  // namespace
+
+Frustum::Frustum(const Pose& pose, const Params& params) {
+  if (!pose.has_rotation) {
+    throw std::runtime_error(pose.rotation_error.empty()
+                                 ? "Frustum culling needs a 'rotation' quaternion in the pose JSON"
+                                 : "Frustum culling needs the pose rotation: " + pose.rotation_error);
+  }
+  if (!(params.fov_h > 0.0f && params.fov_h < 180.0f) || !(params.fov_v > 0.0f && params.fov_v < 180.0f)) {
+    throw std::runtime_error("Frustum fov_h and fov_v must lie in (0, 180) degrees");
+  }
+  if (!(params.near_clip >= 0.0f) || (params.far_clip != 0.0f && !(params.far_clip > params.near_clip))) {
+    throw std::runtime_error("Frustum near must be non-negative and far either 0 or beyond near");
+  }
+  const float deg_to_rad = 3.14159265358979f / 180.0f;
+  tan_h_ = std::tan(0.5f * params.fov_h * deg_to_rad);
+  tan_v_ = std::tan(0.5f * params.fov_v * deg_to_rad);
+  near_ = params.near_clip;
+  far_ = params.far_clip > 0.0f ? params.far_clip : std::numeric_limits<float>::infinity();
+  // Column `axis` of the product is the view, left or up direction in world coordinates.
+  const Eigen::Matrix3f world = pose.R * cameraBasis(params.camera_axes);
+  for (int axis = 0; axis < 3; ++axis) {
+    origin_[axis] = pose.C[axis];
+    for (int k = 0; k < 3; ++k) {
+      axes_[axis][k] = world(k, axis);
+    }
+  }
+}
+
+std::size_t Frustum::contains(const CloudT& cloud, std::vector<std::uint8_t>& mask) const {
+  const std::size_t n = cloud.size();
+  mask.resize(n);
+  // Locals, so the test loop reads no memory beyond the block and the compiler can vectorize it.
+  const float ox = origin_[0], oy = origin_[1], oz = origin_[2];
+  const float f0 = axes_[0][0], f1 = axes_[0][1], f2 = axes_[0][2];
+  const float l0 = axes_[1][0], l1 = axes_[1][1], l2 = axes_[1][2];
+  const float u0 = axes_[2][0], u1 = axes_[2][1], u2 = axes_[2][2];
+  const float tan_h = tan_h_, tan_v = tan_v_, lo = near_, hi = far_;
+  // Points are copied block by block into x/y/z arrays first: over the packed 12-byte core points
+  // the baseline SSE2 target does not vectorize the test at all, and the block keeps it in L1.
+  float x[kBlock], y[kBlock], z[kBlock];
+  std::int32_t in[kBlock];
+  std::size_t inside = 0;
+  for (std::size_t base = 0; base < n; base += kBlock) {
+    const std::size_t count = std::min(kBlock, n - base);
+    const PointT* points = cloud.points.data() + base;
+    for (std::size_t i = 0; i < count; ++i) {
+      x[i] = points[i].x;
+      y[i] = points[i].y;
+      z[i] = points[i].z;
+    }
+    std::fill(x + count, x + kBlock, std::numeric_limits<float>::quiet_NaN());  // fixed trip count
+    int block_inside = 0;
+    for (std::size_t i = 0; i < kBlock; ++i) {
+      const float dx = x[i] - ox;
+      const float dy = y[i] - oy;
+      const float dz = z[i] - oz;
+      const float d = f0 * dx + f1 * dy + f2 * dz;
+      const float left = l0 * dx + l1 * dy + l2 * dz;
+      const float up = u0 * dx + u1 * dy + u2 * dz;
+      // NaN coordinates fail every comparison, so non-finite points (and the padding) come out as 0.
+      in[i] = (d >= lo) & (d <= hi) & (std::fabs(left) <= d * tan_h) & (std::fabs(up) <= d * tan_v);
+      block_inside += in[i];
+    }
+    std::uint8_t* out = mask.data() + base;
+    for (std::size_t i = 0; i < count; ++i) {
+      out[i] = static_cast<std::uint8_t>(in[i]);
+    }
+    inside += static_cast<std::size_t>(block_inside);
+  }
+  return inside;
+}
+
+std::size_t Frustum::cull(CloudT& cloud, PointAttributes* attributes) const {
+  M2C_TRACE_SCOPE("frustumCull");
+  thread_local std::vector<std::uint8_t> mask;
+  const std::size_t inside = contains(cloud, mask);
+  const std::size_t removed = cloud.size() - inside;
+  if (removed == 0) {
+    return 0;
+  }
+  const bool has_attributes = attributes && !attributes->empty();
+  std::vector<int> kept;
+  if (has_attributes) {
+    kept.reserve(inside);
+  }
+  std::size_t next = 0;
+  for (std::size_t i = 0; i < mask.size(); ++i) {
+    if (!mask[i]) continue;
+    cloud.points[next++] = cloud.points[i];
+    if (has_attributes) kept.push_back(static_cast<int>(i));
+  }
+  cloud.points.resize(next);
+  cloud.width = static_cast<std::uint32_t>(next);
+  cloud.height = 1;
+  if (has_attributes) {
+    *attributes = attributes->select(kept);
+  }
+  return removed;
+}
+
+}  // namespace m2c
@@ -0,0 +1,348 @@
+#include "m2c/incremental.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include "m2c/trace.h"
+
+namespace m2c {
+namespace {
+
+constexpr char kStateMagic[4] = {'M', '2', 'C', 'S'};
+constexpr std::uint32_t kStateVersion = 2;  // 1: one snapshot of points and root per point.
+constexpr std::uint64_t kHeaderBytes = sizeof(kStateMagic) + sizeof(std::uint32_t) + sizeof(float);
+
+}  // namespace
+
+IncrementalClusterer::IncrementalClusterer(float eps) : eps_(eps) {
+  if (!(eps > 0.0f)) {
+    throw std::invalid_argument("Incremental clustering requires a positive eps");
+  }
+  cloud_.height = 1;
+  cloud_.is_dense = false;
+}
+
+int IncrementalClusterer::find(int idx) const {
+  while (parent_[idx] != idx) {
+    parent_[idx] = parent_[parent_[idx]];
+    idx = parent_[idx];
+  }
+  return idx;
+}
+
+bool IncrementalClusterer::unite(int a, int b) {
+  a = find(a);
+  b = find(b);
+  if (a == b) {
+    return false;
+  }
+  if (components_[static_cast<std::size_t>(slot_[a])].count < components_[static_cast<std::size_t>(slot_[b])].count) {
+    std::swap(a, b);
+  }
+  parent_[b] = a;
+  std::swap(next_[a], next_[b]);  // splices the two member cycles
+
+  Component& into = components_[static_cast<std::size_t>(slot_[a])];
+  const Component& from = components_[static_cast<std::size_t>(slot_[b])];
+  into.count += from.count;
+  into.min = into.min.cwiseMin(from.min);
+  into.max = into.max.cwiseMax(from.max);
+  into.sum += from.sum;
+
+  // Drop b's component: the last one moves into its position.
+  const std::size_t freed = static_cast<std::size_t>(slot_[b]);
+  const int moved = roots_.back();
+  components_[freed] = components_.back();
+  roots_[freed] = moved;
+  slot_[moved] = static_cast<int>(freed);
+  components_.pop_back();
+  roots_.pop_back();
+  slot_[b] = -1;
+  return true;
+}
+
+int IncrementalClusterer::add(const PointT& p) {
+  const int idx = static_cast<int>(cloud_.size());
+  cloud_.push_back(p);
+  parent_.push_back(idx);
+  next_.push_back(idx);
+  slot_.push_back(static_cast<int>(roots_.size()));
+  roots_.push_back(idx);
+  Component component;
+  component.count = 1;
+  component.min = component.max = Eigen::Vector3f(p.x, p.y, p.z);
+  component.sum = component.min.cast<double>();
+  components_.push_back(component);
+  return idx;
+}
+
+// Grid keys count cells from the first stored point (before any, the batch's first finite one), so
+// they stay small for georeferenced coordinates and load() restores the same frame with the cloud.
+VoxelFrame IncrementalClusterer::gridFrame(const CloudT& batch) const {
+  const float inv = 1.0f / eps_;
+  if (!cloud_.empty()) {
+    return voxelFrame(cloud_[0], inv);
+  }
+  for (const PointT& p : batch) {
+    if (std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z)) {
+      return voxelFrame(p, inv);
+    }
+  }
+  return voxelFrame(PointT(0.0f, 0.0f, 0.0f), inv);
+}
+
+void IncrementalClusterer::prepareGrid(const CloudT& batch, const VoxelFrame& frame) {
+  if (grid_complete_) {
+    return;
+  }
+  Eigen::Vector3f lo = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  Eigen::Vector3f hi = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+  for (const PointT& p : batch) {
+    if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) continue;
+    lo = lo.cwiseMin(Eigen::Vector3f(p.x, p.y, p.z));
+    hi = hi.cwiseMax(Eigen::Vector3f(p.x, p.y, p.z));
+  }
+  if (lo.x() > hi.x()) {
+    return;  // nothing to insert
+  }
+  // Old points within eps of the batch lie in its box grown by eps.
+  lo.array() -= eps_;
+  hi.array() += eps_;
+  if ((lo.array() >= grid_min_.array()).all() && (hi.array() <= grid_max_.array()).all()) {
+    return;
+  }
+  const bool first = grid_min_.x() > grid_max_.x();
+  if (!first) {
+    // A second region: index everything rather than track several boxes.
+    grid_.clear();
+    lo.setConstant(std::numeric_limits<float>::lowest());
+    hi.setConstant(std::numeric_limits<float>::max());
+    grid_complete_ = true;
+  }
+  for (std::size_t i = 0; i < cloud_.size(); ++i) {
+    const PointT& p = cloud_[i];
+    if (p.x >= lo.x() && p.x <= hi.x() && p.y >= lo.y() && p.y <= hi.y() && p.z >= lo.z() && p.z <= hi.z()) {
+      grid_[voxelKeyOf(p, frame)].push_back(static_cast<int>(i));
+    }
+  }
+  grid_min_ = lo;
+  grid_max_ = hi;
+}
+
+void IncrementalClusterer::append(const CloudT& points) {
+  M2C_TRACE_SCOPE("incremental.append");
+  const float eps_sq = eps_ * eps_;
+  const std::size_t capacity = cloud_.size() + points.size();
+  cloud_.reserve(capacity);
+  parent_.reserve(capacity);
+  next_.reserve(capacity);
+  slot_.reserve(capacity);
+  const VoxelFrame frame = gridFrame(points);
+  prepareGrid(points, frame);
+
+  for (const PointT& p : points) {
+    if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) {
+      continue;
+    }
+    // Any neighbor within eps lives in the same or one of the 26 adjacent cells.
+    const VoxelKey key = voxelKeyOf(p, frame);
+    const int idx = add(p);
+    grid_[key].push_back(idx);
+    for (int dz = -1; dz <= 1; ++dz) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+          const auto it = grid_.find(VoxelKey{key.x + dx, key.y + dy, key.z + dz});
+          if (it == grid_.end()) {
+            continue;
+          }
+          for (int other : it->second) {
+            const PointT& q = cloud_[static_cast<std::size_t>(other)];
+            const float ex = p.x - q.x;
+            const float ey = p.y - q.y;
+            const float ez = p.z - q.z;
+            if (other != idx && ex * ex + ey * ey + ez * ez <= eps_sq && unite(idx, other)) {
+              unsaved_unions_.emplace_back(idx, other);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  cloud_.width = static_cast<std::uint32_t>(cloud_.size());
+  cloud_.height = 1;
+}
+
+int IncrementalClusterer::label(int idx) const {
+  if (idx < 0 || static_cast<std::size_t>(idx) >= parent_.size()) {
+    throw std::out_of_range("Point index out of bounds");
+  }
+  return find(idx);
+}
+
+int IncrementalClusterer::componentSize(int idx) const {
+  return components_[static_cast<std::size_t>(slot_[label(idx)])].count;
+}
+
+void IncrementalClusterer::members(std::size_t component, std::vector<int>& out) const {
+  out.clear();
+  const int root = roots_.at(component);
+  out.reserve(static_cast<std::size_t>(components_[component].count));
+  int idx = root;
+  do {
+    out.push_back(idx);
+    idx = next_[static_cast<std::size_t>(idx)];
+  } while (idx != root);
+}
+
+std::vector<int> IncrementalClusterer::labels() const {
+  std::vector<int> out(parent_.size());
+  for (std::size_t i = 0; i < parent_.size(); ++i) {
+    out[i] = slot_[find(static_cast<int>(i))];
+  }
+  return out;
+}
+
+std::vector<PointIndices> IncrementalClusterer::clusters() const {
+  std::vector<PointIndices> out;
+  out.reserve(roots_.size());
+  std::vector<int> position(parent_.size(), -1);
+  for (std::size_t i = 0; i < parent_.size(); ++i) {
+    const int root = find(static_cast<int>(i));
+    if (position[root] < 0) {
+      position[root] = static_cast<int>(out.size());
+      out.emplace_back();
+      out.back().indices.reserve(static_cast<std::size_t>(components_[static_cast<std::size_t>(slot_[root])].count));
+    }
+    out[static_cast<std::size_t>(position[root])].indices.push_back(static_cast<int>(i));
+  }
+  return out;
+}
+
+void IncrementalClusterer::save(const std::string& path) {
+  M2C_TRACE_SCOPE("incremental.save");
+  std::error_code ec;
+  const bool delta = !journal_path_.empty() && path == journal_path_ &&
+                     std::filesystem::file_size(path, ec) == journal_bytes_ && !ec;
+
+  // A full snapshot is one record holding every point, with each point unioned to its root.
+  std::size_t first = saved_points_;
+  std::vector<std::pair<int, int>> snapshot;
+  if (!delta) {
+    first = 0;
+    snapshot.reserve(cloud_.size() - roots_.size());
+    for (std::size_t i = 0; i < parent_.size(); ++i) {
+      const int root = find(static_cast<int>(i));
+      if (root != static_cast<int>(i)) snapshot.emplace_back(static_cast<int>(i), root);
+    }
+  }
+  const std::vector<std::pair<int, int>>& unions = delta ? unsaved_unions_ : snapshot;
+
+  std::ofstream output(path, std::ios::binary | (delta ? std::ios::app : std::ios::trunc));
+  if (!output) {
+    throw std::runtime_error("Failed to open state file for writing: " + path);
+  }
+  std::uint64_t bytes = delta ? journal_bytes_ : kHeaderBytes;
+  if (!delta) {
+    output.write(kStateMagic, sizeof(kStateMagic));
+    output.write(reinterpret_cast<const char*>(&kStateVersion), sizeof(kStateVersion));
+    output.write(reinterpret_cast<const char*>(&eps_), sizeof(eps_));
+  }
+
+  const std::uint64_t point_count = cloud_.size() - first;
+  output.write(reinterpret_cast<const char*>(&point_count), sizeof(point_count));
+  for (std::size_t i = first; i < cloud_.size(); ++i) {
+    const PointT& p = cloud_[i];
+    const float xyz[3] = {p.x, p.y, p.z};
+    output.write(reinterpret_cast<const char*>(xyz), sizeof(xyz));
+  }
+  const std::uint64_t union_count = unions.size();
+  output.write(reinterpret_cast<const char*>(&union_count), sizeof(union_count));
+  for (const auto& u : unions) {
+    const std::int32_t pair[2] = {u.first, u.second};
+    output.write(reinterpret_cast<const char*>(pair), sizeof(pair));
+  }
+  bytes += 2 * sizeof(std::uint64_t) + point_count * 3 * sizeof(float) + union_count * 2 * sizeof(std::int32_t);
+
+  output.close();
+  if (!output) {
+    throw std::runtime_error("Failed to write state file: " + path);
+  }
+  journal_path_ = path;
+  journal_bytes_ = bytes;
+  saved_points_ = cloud_.size();
+  unsaved_unions_.clear();
+}
+
+IncrementalClusterer IncrementalClusterer::load(const std::string& path) {
+  M2C_TRACE_SCOPE("incremental.load");
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    throw std::runtime_error("Failed to open state file: " + path);
+  }
+
+  char magic[4];
+  std::uint32_t version = 0;
+  float eps = 0.0f;
+  input.read(magic, sizeof(magic));
+  input.read(reinterpret_cast<char*>(&version), sizeof(version));
+  input.read(reinterpret_cast<char*>(&eps), sizeof(eps));
+  if (!input || std::memcmp(magic, kStateMagic, sizeof(magic)) != 0) {
+    throw std::runtime_error("Not a mask2cluster state file: " + path);
+  }
+  if (version != kStateVersion) {
+    throw std::runtime_error("Unsupported state file version in " + path + "; delete it to start a new one");
+  }
+
+  IncrementalClusterer state(eps);
+  state.grid_complete_ = false;
+  std::uint64_t bytes = kHeaderBytes;
+  std::vector<float> xyz;
+  std::vector<std::int32_t> pairs;
+  for (;;) {
+    std::uint64_t point_count = 0;
+    if (!input.read(reinterpret_cast<char*>(&point_count), sizeof(point_count))) {
+      if (input.gcount() == 0 && input.eof()) break;  // end of the last record
+      throw std::runtime_error("Truncated state file: " + path);
+    }
+    xyz.resize(static_cast<std::size_t>(point_count) * 3);
+    input.read(reinterpret_cast<char*>(xyz.data()), static_cast<std::streamsize>(xyz.size() * sizeof(float)));
+    std::uint64_t union_count = 0;
+    input.read(reinterpret_cast<char*>(&union_count), sizeof(union_count));
+    if (!input) {
+      throw std::runtime_error("Truncated state file: " + path);
+    }
+    pairs.resize(static_cast<std::size_t>(union_count) * 2);
+    input.read(reinterpret_cast<char*>(pairs.data()), static_cast<std::streamsize>(pairs.size() * sizeof(std::int32_t)));
+    if (!input) {
+      throw std::runtime_error("Truncated state file: " + path);
+    }
+
+    for (std::size_t i = 0; i < xyz.size(); i += 3) {
+      state.add(PointT(xyz[i], xyz[i + 1], xyz[i + 2]));
+    }
+    const std::int64_t count = static_cast<std::int64_t>(state.cloud_.size());
+    for (std::size_t k = 0; k < pairs.size(); k += 2) {
+      if (pairs[k] < 0 || pairs[k] >= count || pairs[k + 1] < 0 || pairs[k + 1] >= count) {
+        throw std::runtime_error("Corrupt union-find state in " + path);
+      }
+      state.unite(pairs[k], pairs[k + 1]);
+    }
+    bytes += 2 * sizeof(std::uint64_t) + xyz.size() * sizeof(float) + pairs.size() * sizeof(std::int32_t);
+  }
+  state.cloud_.width = static_cast<std::uint32_t>(state.cloud_.size());
+  state.cloud_.height = 1;
+  state.journal_path_ = path;
+  state.journal_bytes_ = bytes;
+  state.saved_points_ = state.cloud_.size();
+  return state;
+}
+
+}  // namespace m2c
@@ -3,18 +3,29 @@
 #include <algorithm>
 #include <cctype>
 #include <cstdint>
+#include <fstream>
 #include <memory>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
+#ifndef M2C_CORE_ONLY
 #include <pcl/io/pcd_io.h>
 #include <pcl/io/ply_io.h>
+#endif
+
+#include "m2c/io_ply.h"
+#include "m2c/las_index.h"
+#include "m2c/trace.h"
 
 #ifdef M2C_HAS_PDAL
 #include <pdal/Dimension.hpp>
 #include <pdal/Options.hpp>
 #include <pdal/PointTable.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/PointRef.hpp>
+#include <pdal/filters/StreamCallbackFilter.hpp>
 #include <pdal/io/LasReader.hpp>
 #endif
 
@@ -38,7 +49,7 @@ std::string extensionOf(const std::string& path) {
 }
 
 #ifdef M2C_HAS_PDAL
-CloudT::Ptr loadLasViaPDAL(const std::string& path) {
+CloudT::Ptr loadLasViaPDAL(const std::string& path, PointAttributes* attributes) {
   pdal::Options options;
   options.add("filename", path);
 
@@ -59,6 +70,18 @@ CloudT::Ptr loadLasViaPDAL(const std::string& path) {
     throw std::runtime_error(std::string("PDAL failed to execute reader: ") + e.what());
   }
 
+  using Dim = pdal::Dimension::Id;
+  const pdal::PointLayoutPtr layout = table.layout();
+  const bool intensity = attributes && layout->hasDim(Dim::Intensity);
+  const bool classification = attributes && layout->hasDim(Dim::Classification);
+  const bool color = attributes && layout->hasDim(Dim::Red) && layout->hasDim(Dim::Green) && layout->hasDim(Dim::Blue);
+  const bool scan = attributes && attributes->scan_order && layout->hasDim(Dim::ScanAngleRank) &&
+                    layout->hasDim(Dim::GpsTime);
+  if (attributes) {
+    attributes->clear();
+    attributes->color_bits = 16;
+  }
+
   CloudT::Ptr cloud(new CloudT);
   for (const auto& viewPtr : viewSet) {
     if (!viewPtr) {
@@ -68,10 +91,23 @@ CloudT::Ptr loadLasViaPDAL(const std::string& path) {
     cloud->reserve(cloud->size() + size);
     for (pdal::PointId idx = 0; idx < size; ++idx) {
       PointT point;
-      point.x = static_cast<float>(viewPtr->getFieldAs<double>(pdal::Dimension::Id::X, idx));
-      point.y = static_cast<float>(viewPtr->getFieldAs<double>(pdal::Dimension::Id::Y, idx));
-      point.z = static_cast<float>(viewPtr->getFieldAs<double>(pdal::Dimension::Id::Z, idx));
+      point.x = static_cast<float>(viewPtr->getFieldAs<double>(Dim::X, idx));
+      point.y = static_cast<float>(viewPtr->getFieldAs<double>(Dim::Y, idx));
+      point.z = static_cast<float>(viewPtr->getFieldAs<double>(Dim::Z, idx));
       cloud->push_back(point);
+      if (intensity) attributes->intensity.push_back(viewPtr->getFieldAs<std::uint16_t>(Dim::Intensity, idx));
+      if (classification) {
+        attributes->classification.push_back(viewPtr->getFieldAs<std::uint8_t>(Dim::Classification, idx));
+      }
+      if (color) {
+        attributes->red.push_back(viewPtr->getFieldAs<std::uint16_t>(Dim::Red, idx));
+        attributes->green.push_back(viewPtr->getFieldAs<std::uint16_t>(Dim::Green, idx));
+        attributes->blue.push_back(viewPtr->getFieldAs<std::uint16_t>(Dim::Blue, idx));
+      }
+      if (scan) {
+        attributes->scan_angle.push_back(viewPtr->getFieldAs<float>(Dim::ScanAngleRank, idx));
+        attributes->gps_time.push_back(viewPtr->getFieldAs<double>(Dim::GpsTime, idx));
+      }
     }
   }
 
@@ -80,22 +116,155 @@ CloudT::Ptr loadLasViaPDAL(const std::string& path) {
   cloud->is_dense = false;
   return cloud;
 }
+
+void streamLasViaPDAL(const std::string& path,
+                      std::size_t chunk_points,
+                      const std::function<void(const CloudT&)>& callback,
+                      PointAttributes* attributes) {
+  pdal::Options options;
+  options.add("filename", path);
+
+  pdal::LasReader reader;
+  reader.setOptions(options);
+
+  using Dim = pdal::Dimension::Id;
+  bool intensity = false;
+  bool classification = false;
+  bool color = false;
+  bool scan = false;
+  const auto startAttributes = [&]() {
+    if (!attributes) return;
+    attributes->clear();
+    attributes->color_bits = 16;
+  };
+
+  CloudT chunk;
+  chunk.reserve(chunk_points);
+  const auto emit = [&]() {
+    chunk.width = static_cast<std::uint32_t>(chunk.size());
+    chunk.height = 1;
+    chunk.is_dense = false;
+    callback(chunk);
+    chunk.clear();
+    startAttributes();
+  };
+  startAttributes();
+
+  pdal::StreamCallbackFilter sink;
+  sink.setInput(reader);
+  sink.setCallback([&](pdal::PointRef& point) {
+    chunk.push_back(PointT(static_cast<float>(point.getFieldAs<double>(Dim::X)),
+                           static_cast<float>(point.getFieldAs<double>(Dim::Y)),
+                           static_cast<float>(point.getFieldAs<double>(Dim::Z))));
+    if (intensity) attributes->intensity.push_back(point.getFieldAs<std::uint16_t>(Dim::Intensity));
+    if (classification) attributes->classification.push_back(point.getFieldAs<std::uint8_t>(Dim::Classification));
+    if (color) {
+      attributes->red.push_back(point.getFieldAs<std::uint16_t>(Dim::Red));
+      attributes->green.push_back(point.getFieldAs<std::uint16_t>(Dim::Green));
+      attributes->blue.push_back(point.getFieldAs<std::uint16_t>(Dim::Blue));
+    }
+    if (scan) {
+      attributes->scan_angle.push_back(point.getFieldAs<float>(Dim::ScanAngleRank));
+      attributes->gps_time.push_back(point.getFieldAs<double>(Dim::GpsTime));
+    }
+    if (chunk.size() >= chunk_points) {
+      emit();
+    }
+    return true;
+  });
+
+  // PDAL only keeps `capacity` points resident while streaming.
+  pdal::FixedPointTable table(static_cast<pdal::point_count_t>(std::min<std::size_t>(chunk_points, 65536)));
+  try {
+    sink.prepare(table);
+    const pdal::PointLayoutPtr layout = table.layout();
+    intensity = attributes && layout->hasDim(Dim::Intensity);
+    classification = attributes && layout->hasDim(Dim::Classification);
+    color = attributes && layout->hasDim(Dim::Red) && layout->hasDim(Dim::Green) && layout->hasDim(Dim::Blue);
+    scan = attributes && attributes->scan_order && layout->hasDim(Dim::ScanAngleRank) && layout->hasDim(Dim::GpsTime);
+    sink.execute(table);
+  } catch (const pdal::pdal_error& e) {
+    throw std::runtime_error(std::string("PDAL failed to stream LAS file: ") + e.what());
+  }
+  if (!chunk.empty()) {
+    emit();
+  }
+}
 #endif
 
-}  // namespace
+CloudT::Ptr cropToRoi(const CloudT& cloud, const Roi& roi, PointAttributes* attributes) {
+  CloudT::Ptr cropped(new CloudT);
+  std::vector<int> kept;
+  const float r2 = roi.radius * roi.radius;
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    const PointT& point = cloud[i];
+    if ((Eigen::Vector3f(point.x, point.y, point.z) - roi.center).squaredNorm() <= r2) {
+      cropped->push_back(point);
+      if (attributes) kept.push_back(static_cast<int>(i));
+    }
+  }
+  if (attributes) {
+    *attributes = attributes->select(kept);
+  }
+  cropped->width = static_cast<std::uint32_t>(cropped->size());
+  cropped->height = 1;
+  cropped->is_dense = false;
+  return cropped;
+}
 
-CloudT::Ptr loadAnyPointCloud(const std::string& path) {
-  const std::string ext = extensionOf(path);
+using ChunkReader = bool (*)(const std::string&,
+                             std::size_t,
+                             const std::function<void(const CloudT&)>&,
+                             PointAttributes*);
+
+// Collects a native chunked reader into one cloud; nullptr when the reader declines the file.
+CloudT::Ptr loadViaChunks(ChunkReader reader, const std::string& path, PointAttributes* attributes) {
+  CloudT::Ptr cloud(new CloudT);
+  PointAttributes chunk_attributes;
+  if (attributes) {
+    attributes->clear();
+    chunk_attributes.scan_order = attributes->scan_order;
+  }
+  const bool ok = reader(path, std::size_t(1) << 20, [&](const CloudT& chunk) {
+    cloud->points.insert(cloud->points.end(), chunk.points.begin(), chunk.points.end());
+    if (attributes) attributes->append(chunk_attributes);
+  }, attributes ? &chunk_attributes : nullptr);
+  if (!ok) {
+    return nullptr;
+  }
+  cloud->width = static_cast<std::uint32_t>(cloud->size());
+  cloud->height = 1;
+  cloud->is_dense = false;
+  return cloud;
+}
+
+CloudT::Ptr loadWholeCloud(const std::string& path, const std::string& ext, PointAttributes* attributes) {
   if (ext == ".las") {
 #ifdef M2C_HAS_PDAL
-    return loadLasViaPDAL(path);
+    return loadLasViaPDAL(path, attributes);
 #else
+    if (CloudT::Ptr cloud = loadViaChunks(forEachLasChunk, path, attributes)) {
+      return cloud;
+    }
     throw std::runtime_error(
-        "LAS input requested but PDAL support was not built. Reconfigure with M2C_WITH_PDAL=ON and ensure PDAL is installed.");
+        "Compressed LAS input requires PDAL support. Reconfigure with M2C_WITH_PDAL=ON and ensure PDAL is installed.");
 #endif
   }
 
   if (ext == ".ply") {
+#ifdef M2C_CORE_ONLY
+    if (CloudT::Ptr cloud = loadViaChunks(forEachPlyChunk, path, attributes)) {
+      return cloud;
+    }
+    throw std::runtime_error("Unsupported PLY layout (the core-only reader needs a leading vertex element): " + path);
+#else
+    // pcl::PointXYZ drops every other property; the native reader keeps the passthrough columns.
+    if (attributes) {
+      if (CloudT::Ptr cloud = loadViaChunks(forEachPlyChunk, path, attributes)) {
+        return cloud;
+      }
+      attributes->clear();
+    }
     CloudT::Ptr cloud(new CloudT);
     const int ret = pcl::io::loadPLYFile(path, *cloud);
     if (ret < 0) {
@@ -105,9 +274,13 @@ CloudT::Ptr loadAnyPointCloud(const std::string& path) {
     cloud->height = 1;
     cloud->is_dense = false;
     return cloud;
+#endif
   }
 
   if (ext == ".pcd") {
+#ifdef M2C_CORE_ONLY
+    throw std::runtime_error("PCD input needs the PCL adapter; rebuild without M2C_CORE_ONLY or convert to PLY: " + path);
+#else
     CloudT::Ptr cloud(new CloudT);
     const int ret = pcl::io::loadPCDFile(path, *cloud);
     if (ret < 0) {
@@ -117,9 +290,100 @@ CloudT::Ptr loadAnyPointCloud(const std::string& path) {
     cloud->height = 1;
     cloud->is_dense = false;
     return cloud;
+#endif
   }
 
   throw std::runtime_error("Unsupported point cloud extension: " + ext + " for path: " + path);
 }
 
+}  // namespace
+
+CloudT::Ptr loadAnyPointCloud(const std::string& path, const Roi* roi, PointAttributes* attributes) {
+  M2C_TRACE_SCOPE("loadAnyPointCloud");
+  const std::string ext = extensionOf(path);
+  if (attributes) {
+    attributes->clear();
+  }
+  if (roi == nullptr) {
+    return loadWholeCloud(path, ext, attributes);
+  }
+  if (ext == ".las") {
+    if (CloudT::Ptr region = loadLasRegion(path, *roi, attributes)) {
+      return region;
+    }
+  }
+  // No usable index: same result, but load time and memory scale with the file.
+  return cropToRoi(*loadWholeCloud(path, ext, attributes), *roi, attributes);
+}
+
+void forEachPointChunk(const std::string& path,
+                       std::size_t chunk_points,
+                       const std::function<void(const CloudT&)>& callback,
+                       PointAttributes* attributes) {
+  M2C_TRACE_SCOPE("forEachPointChunk");
+  chunk_points = std::max<std::size_t>(1, chunk_points);
+  const std::string ext = extensionOf(path);
+#ifdef M2C_HAS_PDAL
+  if (ext == ".las") {
+    streamLasViaPDAL(path, chunk_points, callback, attributes);
+    return;
+  }
+#else
+  if (ext == ".las" && forEachLasChunk(path, chunk_points, callback, attributes)) {
+    return;
+  }
+#endif
+  if (ext == ".ply" && forEachPlyChunk(path, chunk_points, callback, attributes)) {
+    return;
+  }
+
+  // Whole-file fallback: still hands out bounded chunks so callers need a single code path.
+  PointAttributes all;
+  all.scan_order = attributes && attributes->scan_order;
+  const CloudT::Ptr cloud = loadAnyPointCloud(path, nullptr, attributes ? &all : nullptr);
+  CloudT chunk;
+  std::vector<int> rows;
+  for (std::size_t begin = 0; begin < cloud->size(); begin += chunk_points) {
+    const std::size_t end = std::min(cloud->size(), begin + chunk_points);
+    chunk.clear();
+    chunk.reserve(end - begin);
+    for (std::size_t i = begin; i < end; ++i) {
+      chunk.push_back((*cloud)[i]);
+    }
+    chunk.width = static_cast<std::uint32_t>(chunk.size());
+    chunk.height = 1;
+    chunk.is_dense = false;
+    if (attributes) {
+      rows.clear();
+      for (std::size_t i = begin; i < end; ++i) rows.push_back(static_cast<int>(i));
+      *attributes = all.select(rows);
+    }
+    callback(chunk);
+  }
+}
+
+std::size_t pointCountHint(const std::string& path) {
+  const std::string ext = extensionOf(path);
+  try {
+    if (ext == ".las") {
+      return static_cast<std::size_t>(lasPointCount(path));
+    }
+  } catch (const std::exception&) {
+    return 0;  // The loader itself reports malformed input.
+  }
+  if (ext == ".ply") {
+    std::ifstream input(path, std::ios::binary);
+    std::string line;
+    while (std::getline(input, line) && line.rfind("end_header", 0) != 0) {
+      std::istringstream tokens(line);
+      std::string keyword, name;
+      std::size_t count = 0;
+      if (tokens >> keyword >> name >> count && keyword == "element" && name == "vertex") {
+        return count;
+      }
+    }
+  }
+  return 0;
+}
+
 }  // namespace m2c
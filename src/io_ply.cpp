@@ -0,0 +1,444 @@
+#include "m2c/io_ply.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "m2c/trace.h"
+
+namespace m2c {
+namespace {
+
+constexpr std::size_t kBufferBytes = 1u << 20;
+
+bool hostIsLittleEndian() {
+  const std::uint16_t probe = 1;
+  unsigned char first = 0;
+  std::memcpy(&first, &probe, 1);
+  return first == 1;
+}
+
+// Append-only file sink that batches small records into large write() calls.
+class BufferedFile {
+ public:
+  explicit BufferedFile(const std::string& path) : path_(path) {
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+      throw std::runtime_error("Failed to open PLY file for writing: " + path + ": " + std::strerror(errno));
+    }
+    buffer_.resize(kBufferBytes);
+  }
+
+  ~BufferedFile() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  BufferedFile(const BufferedFile&) = delete;
+  BufferedFile& operator=(const BufferedFile&) = delete;
+
+  void append(const void* data, std::size_t bytes) {
+    if (used_ + bytes > buffer_.size()) {
+      flush();
+      if (bytes > buffer_.size()) {
+        writeAll(static_cast<const char*>(data), bytes);
+        return;
+      }
+    }
+    std::memcpy(buffer_.data() + used_, data, bytes);
+    used_ += bytes;
+  }
+
+  void flush() {
+    writeAll(buffer_.data(), used_);
+    used_ = 0;
+  }
+
+  void close() {
+    flush();
+    const int rc = ::close(fd_);
+    fd_ = -1;
+    if (rc != 0) {
+      throw std::runtime_error("Failed to close PLY file: " + path_);
+    }
+  }
+
+ private:
+  std::string path_;
+  int fd_ = -1;
+  std::vector<char> buffer_;
+  std::size_t used_ = 0;
+
+  void writeAll(const char* data, std::size_t bytes) {
+    std::size_t done = 0;
+    while (done < bytes) {
+      const ssize_t n = ::write(fd_, data + done, bytes - done);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        throw std::runtime_error("Failed to write PLY file: " + path_ + ": " + std::strerror(errno));
+      }
+      done += static_cast<std::size_t>(n);
+    }
+  }
+};
+
+// Columns of `attributes` that go into the export; all absent for nullptr.
+struct AttributeColumns {
+  const PointAttributes* source = nullptr;
+  bool intensity = false;
+  bool classification = false;
+  bool color = false;
+  bool color8 = false;
+
+  AttributeColumns(const PointAttributes* attributes, std::size_t points) : source(attributes) {
+    if (!attributes) {
+      return;
+    }
+    intensity = attributes->hasIntensity();
+    classification = attributes->hasClassification();
+    color = attributes->hasColor();
+    color8 = attributes->color_bits <= 8;
+    const bool aligned = (!intensity || attributes->intensity.size() == points) &&
+                         (!classification || attributes->classification.size() == points) &&
+                         (!color || (attributes->red.size() == points && attributes->green.size() == points &&
+                                     attributes->blue.size() == points));
+    if (!aligned) {
+      throw std::invalid_argument("Point attribute columns do not match the cloud size");
+    }
+  }
+
+  std::size_t recordBytes() const {
+    return (intensity ? 2 : 0) + (classification ? 1 : 0) + (color ? (color8 ? 3 : 6) : 0);
+  }
+
+  std::string header() const {
+    std::string lines;
+    if (intensity) lines += "property ushort intensity\n";
+    if (classification) lines += "property uchar classification\n";
+    if (color) {
+      const char* type = color8 ? "uchar" : "ushort";
+      for (const char* channel : {"red", "green", "blue"}) {
+        lines += std::string("property ") + type + " " + channel + "\n";
+      }
+    }
+    return lines;
+  }
+
+  // Encodes the attributes of point `i` at `out`; returns the bytes written.
+  std::size_t pack(std::size_t i, char* out) const {
+    char* at = out;
+    const auto put16 = [&at](std::uint16_t v) {
+      std::memcpy(at, &v, 2);
+      at += 2;
+    };
+    if (intensity) put16(source->intensity[i]);
+    if (classification) *at++ = static_cast<char>(source->classification[i]);
+    if (color) {
+      for (const std::vector<std::uint16_t>* channel : {&source->red, &source->green, &source->blue}) {
+        if (color8) {
+          *at++ = static_cast<char>((*channel)[i]);
+        } else {
+          put16((*channel)[i]);
+        }
+      }
+    }
+    return static_cast<std::size_t>(at - out);
+  }
+};
+
+void writeHeader(BufferedFile& file, std::size_t vertices, bool with_cluster, const AttributeColumns& columns) {
+  std::string header = "ply\nformat ";
+  header += hostIsLittleEndian() ? "binary_little_endian" : "binary_big_endian";
+  header += " 1.0\ncomment written by mask2cluster\nelement vertex " + std::to_string(vertices) +
+            "\nproperty float x\nproperty float y\nproperty float z\n";
+  header += columns.header();
+  if (with_cluster) {
+    header += "property int cluster\n";
+  }
+  header += "end_header\n";
+  file.append(header.data(), header.size());
+}
+
+enum class PlyFormat { Ascii, BinaryLittle, BinaryBig };
+
+struct PlyProperty {
+  std::string name;
+  std::size_t size = 0;    // bytes in binary encodings
+  bool floating = false;
+  bool is_signed = false;
+};
+
+std::size_t plyTypeSize(const std::string& type, bool& floating, bool& is_signed) {
+  floating = type == "float" || type == "float32" || type == "double" || type == "float64";
+  is_signed = floating || type == "char" || type == "int8" || type == "short" || type == "int16" ||
+              type == "int" || type == "int32";
+  if (type == "char" || type == "uchar" || type == "int8" || type == "uint8") return 1;
+  if (type == "short" || type == "ushort" || type == "int16" || type == "uint16") return 2;
+  if (type == "int" || type == "uint" || type == "int32" || type == "uint32" || type == "float" || type == "float32") return 4;
+  if (type == "double" || type == "float64") return 8;
+  return 0;
+}
+
+double decodeScalar(const char* src, const PlyProperty& prop, bool swap) {
+  unsigned char raw[8];
+  std::memcpy(raw, src, prop.size);
+  if (swap) {
+    std::reverse(raw, raw + prop.size);
+  }
+  if (prop.floating) {
+    if (prop.size == 4) {
+      float v;
+      std::memcpy(&v, raw, 4);
+      return v;
+    }
+    double v;
+    std::memcpy(&v, raw, 8);
+    return v;
+  }
+  switch (prop.size) {
+    case 1: return prop.is_signed ? static_cast<double>(static_cast<std::int8_t>(raw[0])) : raw[0];
+    case 2: {
+      std::uint16_t v;
+      std::memcpy(&v, raw, 2);
+      return prop.is_signed ? static_cast<double>(static_cast<std::int16_t>(v)) : v;
+    }
+    default: {
+      std::uint32_t v;
+      std::memcpy(&v, raw, 4);
+      return prop.is_signed ? static_cast<double>(static_cast<std::int32_t>(v)) : v;
+    }
+  }
+}
+
+}  // namespace
+
+std::size_t writePlyBinary(const std::string& path,
+                           const CloudT& cloud,
+                           const std::vector<int>& indices,
+                           const PointAttributes* attributes) {
+  M2C_TRACE_SCOPE("writePly");
+  const AttributeColumns columns(attributes, cloud.size());
+  std::size_t valid = 0;
+  for (int idx : indices) {
+    if (idx >= 0 && static_cast<std::size_t>(idx) < cloud.size()) ++valid;
+  }
+
+  BufferedFile file(path);
+  writeHeader(file, valid, false, columns);
+  char record[3 * sizeof(float) + 16];
+  for (int idx : indices) {
+    if (idx < 0 || static_cast<std::size_t>(idx) >= cloud.size()) continue;
+    const PointT& p = cloud[static_cast<std::size_t>(idx)];
+    const float xyz[3] = {p.x, p.y, p.z};
+    std::memcpy(record, xyz, sizeof(xyz));
+    const std::size_t extra = columns.pack(static_cast<std::size_t>(idx), record + sizeof(xyz));
+    file.append(record, sizeof(xyz) + extra);
+  }
+  file.close();
+  return valid;
+}
+
+std::size_t writePlyLabeled(const std::string& path,
+                            const CloudT& cloud,
+                            const std::vector<int>& labels,
+                            const PointAttributes* attributes) {
+  M2C_TRACE_SCOPE("writePlyLabeled");
+  if (labels.size() != cloud.size()) {
+    throw std::invalid_argument("Label count does not match cloud size");
+  }
+  const AttributeColumns columns(attributes, cloud.size());
+
+  BufferedFile file(path);
+  writeHeader(file, cloud.size(), true, columns);
+  char record[3 * sizeof(float) + 16 + sizeof(std::int32_t)];
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    const PointT& p = cloud[i];
+    const float xyz[3] = {p.x, p.y, p.z};
+    const std::int32_t label = labels[i];
+    std::memcpy(record, xyz, sizeof(xyz));
+    const std::size_t extra = columns.pack(i, record + sizeof(xyz));
+    std::memcpy(record + sizeof(xyz) + extra, &label, sizeof(label));
+    file.append(record, sizeof(xyz) + extra + sizeof(label));
+  }
+  file.close();
+  return cloud.size();
+}
+
+bool forEachPlyChunk(const std::string& path,
+                     std::size_t chunk_points,
+                     const std::function<void(const CloudT&)>& callback,
+                     PointAttributes* attributes) {
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    throw std::runtime_error("Failed to open PLY file: " + path);
+  }
+
+  std::string line;
+  std::getline(input, line);
+  if (line.rfind("ply", 0) != 0) {
+    throw std::runtime_error("Not a PLY file: " + path);
+  }
+
+  PlyFormat format = PlyFormat::Ascii;
+  std::vector<PlyProperty> props;
+  std::size_t vertices = 0;
+  bool seen_element = false;
+  bool in_vertex = false;
+  while (std::getline(input, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    std::istringstream tokens(line);
+    std::string keyword;
+    tokens >> keyword;
+    if (keyword == "end_header") {
+      break;
+    }
+    if (keyword == "format") {
+      std::string name;
+      tokens >> name;
+      if (name == "ascii") format = PlyFormat::Ascii;
+      else if (name == "binary_little_endian") format = PlyFormat::BinaryLittle;
+      else if (name == "binary_big_endian") format = PlyFormat::BinaryBig;
+      else throw std::runtime_error("Unknown PLY format '" + name + "' in " + path);
+    } else if (keyword == "element") {
+      std::string name;
+      tokens >> name;
+      if (!seen_element && name != "vertex") {
+        return false;  // vertex data is not first in the body
+      }
+      in_vertex = !seen_element && name == "vertex";
+      if (in_vertex) tokens >> vertices;
+      seen_element = true;
+    } else if (keyword == "property" && in_vertex) {
+      std::string type;
+      tokens >> type;
+      if (type == "list") {
+        return false;
+      }
+      PlyProperty prop;
+      tokens >> prop.name;
+      prop.size = plyTypeSize(type, prop.floating, prop.is_signed);
+      if (prop.size == 0) {
+        throw std::runtime_error("Unsupported PLY property type '" + type + "' in " + path);
+      }
+      props.push_back(prop);
+    }
+  }
+
+  int axis[3] = {-1, -1, -1};
+  std::size_t offsets[3] = {0, 0, 0};
+  std::size_t stride = 0;
+  for (std::size_t i = 0; i < props.size(); ++i) {
+    for (int a = 0; a < 3; ++a) {
+      if (props[i].name == std::string(1, static_cast<char>('x' + a))) {
+        axis[a] = static_cast<int>(i);
+        offsets[a] = stride;
+      }
+    }
+    stride += props[i].size;
+  }
+  if (axis[0] < 0 || axis[1] < 0 || axis[2] < 0) {
+    throw std::runtime_error("PLY vertex element lacks x/y/z in " + path);
+  }
+
+  // Passthrough attributes: intensity, classification, red, green, blue.
+  static const char* const kAttributeNames[5] = {"intensity", "classification", "red", "green", "blue"};
+  int attr[5] = {-1, -1, -1, -1, -1};
+  std::size_t attr_offsets[5] = {0, 0, 0, 0, 0};
+  if (attributes) {
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < props.size(); ++i) {
+      for (int a = 0; a < 5; ++a) {
+        if (props[i].name == kAttributeNames[a]) {
+          attr[a] = static_cast<int>(i);
+          attr_offsets[a] = offset;
+        }
+      }
+      offset += props[i].size;
+    }
+    if (attr[2] < 0 || attr[3] < 0 || attr[4] < 0) {
+      attr[2] = attr[3] = attr[4] = -1;
+    }
+  }
+  const auto startAttributes = [&]() {
+    if (!attributes) return;
+    attributes->clear();
+    attributes->color_bits = attr[2] >= 0 && props[static_cast<std::size_t>(attr[2])].size == 1 ? 8 : 16;
+  };
+  const auto clampTo = [](double value, double hi) { return std::min(std::max(value, 0.0), hi); };
+  // `value(a)` yields the decoded scalar of attribute slot `a` for the current vertex.
+  const auto pushAttributes = [&](const auto& value) {
+    if (!attributes) return;
+    if (attr[0] >= 0) attributes->intensity.push_back(static_cast<std::uint16_t>(clampTo(value(0), 65535.0)));
+    if (attr[1] >= 0) attributes->classification.push_back(static_cast<std::uint8_t>(clampTo(value(1), 255.0)));
+    if (attr[2] >= 0) {
+      attributes->red.push_back(static_cast<std::uint16_t>(clampTo(value(2), 65535.0)));
+      attributes->green.push_back(static_cast<std::uint16_t>(clampTo(value(3), 65535.0)));
+      attributes->blue.push_back(static_cast<std::uint16_t>(clampTo(value(4), 65535.0)));
+    }
+  };
+
+  chunk_points = std::max<std::size_t>(1, chunk_points);
+  CloudT chunk;
+  chunk.reserve(std::min(chunk_points, vertices));
+  const auto emit = [&]() {
+    chunk.width = static_cast<std::uint32_t>(chunk.size());
+    chunk.height = 1;
+    chunk.is_dense = false;
+    callback(chunk);
+    chunk.clear();
+    startAttributes();
+  };
+  startAttributes();
+
+  if (format == PlyFormat::Ascii) {
+    std::vector<double> values(props.size());
+    for (std::size_t v = 0; v < vertices; ++v) {
+      for (double& value : values) {
+        if (!(input >> value)) {
+          throw std::runtime_error("Truncated ASCII PLY body in " + path);
+        }
+      }
+      chunk.push_back(PointT(static_cast<float>(values[axis[0]]), static_cast<float>(values[axis[1]]),
+                             static_cast<float>(values[axis[2]])));
+      pushAttributes([&](int a) { return values[static_cast<std::size_t>(attr[a])]; });
+      if (chunk.size() >= chunk_points) emit();
+    }
+  } else {
+    const bool swap = (format == PlyFormat::BinaryLittle) != hostIsLittleEndian();
+    const std::size_t batch = std::min(chunk_points, std::max<std::size_t>(1, kBufferBytes / stride));
+    std::vector<char> block(batch * stride);
+    for (std::size_t done = 0; done < vertices;) {
+      const std::size_t count = std::min(batch, vertices - done);
+      input.read(block.data(), static_cast<std::streamsize>(count * stride));
+      if (!input) {
+        throw std::runtime_error("Truncated binary PLY body in " + path);
+      }
+      for (std::size_t r = 0; r < count; ++r) {
+        const char* rec = block.data() + r * stride;
+        chunk.push_back(PointT(static_cast<float>(decodeScalar(rec + offsets[0], props[axis[0]], swap)),
+                               static_cast<float>(decodeScalar(rec + offsets[1], props[axis[1]], swap)),
+                               static_cast<float>(decodeScalar(rec + offsets[2], props[axis[2]], swap))));
+        pushAttributes([&](int a) {
+          return decodeScalar(rec + attr_offsets[a], props[static_cast<std::size_t>(attr[a])], swap);
+        });
+        if (chunk.size() >= chunk_points) emit();
+      }
+      done += count;
+    }
+  }
+
+  if (!chunk.empty()) emit();
+  return true;
+}
+
+}  // namespace m2c
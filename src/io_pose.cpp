@@ -4,6 +4,7 @@
 #include <sstream>
 #include <stdexcept>
 
+#include <Eigen/Geometry>
 #include <nlohmann/json.hpp>
 
 namespace m2c {
@@ -44,6 +45,24 @@ Pose loadPoseJSON(const std::string& json_path) {
     throw std::runtime_error(oss.str());
   }
 
+  // The rotation only matters to the frustum prefilter: a malformed one is recorded, not fatal, so
+  // translation-only runs accept any pose that has a translation.
+  if (doc.contains("rotation")) {
+    const nlohmann::json& rotation = doc["rotation"];
+    try {
+      const Eigen::Quaternionf q(rotation.at("w").get<float>(), rotation.at("x").get<float>(),
+                                 rotation.at("y").get<float>(), rotation.at("z").get<float>());
+      if (q.norm() > 1e-6f) {
+        pose.R = q.normalized().toRotationMatrix();
+        pose.has_rotation = true;
+      } else {
+        pose.rotation_error = "rotation quaternion has zero length in " + json_path;
+      }
+    } catch (const std::exception& e) {
+      pose.rotation_error = "malformed rotation quaternion in " + json_path + ": " + e.what();
+    }
+  }
+
   return pose;
 }
 
@@ -0,0 +1,124 @@
+#include "m2c/kdtree.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "m2c/trace.h"
+
+namespace m2c {
+namespace {
+
+// Queries per block: one block is one unit of parallel work and one staging buffer.
+constexpr std::size_t kBlockQueries = 1024;
+
+// Runs `query(q, indices, sqr_distances)` for q in [0, count) and gathers the results into `out`.
+// Each block stages its hits in its own buffer, so blocks run on any thread without sharing
+// writes; a prefix sum over the per-query counts then places every block in the CSR arrays.
+template <typename Query>
+void runBatch(std::size_t count, KDBatchResult& out, const Query& query) {
+  out.offsets.assign(count + 1, 0);
+  const std::size_t block_count = (count + kBlockQueries - 1) / kBlockQueries;
+
+  int threads = 1;
+#ifdef _OPENMP
+  threads = std::max(1, std::min<int>(omp_get_max_threads(), static_cast<int>(block_count)));
+#endif
+  if (threads == 1) {
+    // One thread: append straight to the CSR arrays, skipping the staging copy.
+    thread_local KDScratch scratch;
+    out.indices.clear();
+    out.sqr_distances.clear();
+    for (std::size_t q = 0; q < count; ++q) {
+      query(q, scratch.indices, scratch.sqr_distances);
+      out.indices.insert(out.indices.end(), scratch.indices.begin(), scratch.indices.end());
+      out.sqr_distances.insert(out.sqr_distances.end(), scratch.sqr_distances.begin(), scratch.sqr_distances.end());
+      out.offsets[q + 1] = out.indices.size();
+    }
+    return;
+  }
+
+  out.blocks.resize(block_count);
+  const long long blocks = static_cast<long long>(block_count);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+#endif
+  for (long long b = 0; b < blocks; ++b) {
+    thread_local KDScratch scratch;
+    KDScratch& block = out.blocks[static_cast<std::size_t>(b)];
+    block.indices.clear();
+    block.sqr_distances.clear();
+    const std::size_t begin = static_cast<std::size_t>(b) * kBlockQueries;
+    const std::size_t end = std::min(count, begin + kBlockQueries);
+    for (std::size_t q = begin; q < end; ++q) {
+      query(q, scratch.indices, scratch.sqr_distances);
+      out.offsets[q + 1] = scratch.indices.size();
+      block.indices.insert(block.indices.end(), scratch.indices.begin(), scratch.indices.end());
+      block.sqr_distances.insert(block.sqr_distances.end(), scratch.sqr_distances.begin(), scratch.sqr_distances.end());
+    }
+  }
+
+  for (std::size_t q = 0; q < count; ++q) {
+    out.offsets[q + 1] += out.offsets[q];
+  }
+  out.indices.resize(out.offsets[count]);
+  out.sqr_distances.resize(out.offsets[count]);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+  for (long long b = 0; b < blocks; ++b) {
+    const KDScratch& block = out.blocks[static_cast<std::size_t>(b)];
+    const std::size_t at = out.offsets[static_cast<std::size_t>(b) * kBlockQueries];
+    std::copy(block.indices.begin(), block.indices.end(), out.indices.begin() + static_cast<std::ptrdiff_t>(at));
+    std::copy(block.sqr_distances.begin(), block.sqr_distances.end(),
+              out.sqr_distances.begin() + static_cast<std::ptrdiff_t>(at));
+  }
+}
+
+// Exceptions cannot leave an OpenMP region, so index batches are validated before it starts.
+void checkIndices(const std::vector<int>& indices, std::size_t cloud_size) {
+  for (int idx : indices) {
+    if (idx < 0 || static_cast<std::size_t>(idx) >= cloud_size) {
+      throw std::out_of_range("Query index out of bounds");
+    }
+  }
+}
+
+}  // namespace
+
+void KD::radiusBatch(const std::vector<int>& indices, float r, KDBatchResult& out, int max_nn) const {
+  M2C_TRACE_SCOPE("kdRadiusBatch");
+  checkIndices(indices, size());
+  runBatch(indices.size(), out, [&](std::size_t q, std::vector<int>& hits, std::vector<float>& d2) {
+    radius(indices[q], r, hits, max_nn, &d2);
+  });
+}
+
+void KD::radiusBatch(const CloudT& queries, float r, KDBatchResult& out, int max_nn) const {
+  M2C_TRACE_SCOPE("kdRadiusBatch");
+  runBatch(queries.size(), out, [&](std::size_t q, std::vector<int>& hits, std::vector<float>& d2) {
+    radius(queries[q], r, hits, max_nn, &d2);
+  });
+}
+
+void KD::knnBatch(const std::vector<int>& indices, int k, KDBatchResult& out) const {
+  M2C_TRACE_SCOPE("kdKnnBatch");
+  checkIndices(indices, size());
+  runBatch(indices.size(), out, [&](std::size_t q, std::vector<int>& hits, std::vector<float>& d2) {
+    knn(indices[q], k, hits, &d2);
+  });
+}
+
+void KD::knnBatch(const CloudT& queries, int k, KDBatchResult& out) const {
+  M2C_TRACE_SCOPE("kdKnnBatch");
+  runBatch(queries.size(), out, [&](std::size_t q, std::vector<int>& hits, std::vector<float>& d2) {
+    knn(queries[q], k, hits, &d2);
+  });
+}
+
+}  // namespace m2c
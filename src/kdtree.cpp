@@ -1,43 +1,109 @@
 #include "m2c/kdtree.h"
 
+#include <algorithm>
 #include <stdexcept>
 
+#include <pcl/common/point_tests.h>
 #include <pcl/search/kdtree.h>
 
+#include "m2c/brute_force.h"
+
 namespace m2c {
 
 struct KD::State {
+  SearchBackend backend = SearchBackend::Tree;
   CloudT::ConstPtr input_cloud;
   pcl::search::KdTree<PointT>::Ptr tree;
+  std::unique_ptr<BruteForceIndex> brute;  // Replaces `tree` for small clouds.
 };
 
-KD::KD(const CloudT& cloud) : state_(std::make_shared<State>()) {
+KD::KD(const CloudT& cloud, const KDOptions& options) : state_(std::make_shared<State>()) {
   if (cloud.empty()) {
     throw std::invalid_argument("Cannot build KDTree on an empty cloud");
   }
 
   state_->input_cloud = CloudT::ConstPtr(&cloud, [](const CloudT*) {});
+  state_->backend = chooseSearchBackend(cloud, options);
+  if (options.poll) options.poll();
+  if (state_->backend == SearchBackend::BruteForce) {
+    state_->brute.reset(new BruteForceIndex(cloud));
+    return;
+  }
   state_->tree.reset(new pcl::search::KdTree<PointT>);
   state_->tree->setInputCloud(state_->input_cloud);
+  if (options.poll) options.poll();
+}
+
+SearchBackend KD::backend() const {
+  return state_ ? state_->backend : SearchBackend::Tree;
+}
+
+std::size_t KD::size() const {
+  return state_ && state_->input_cloud ? state_->input_cloud->size() : 0;
 }
 
-void KD::radius(int idx, float r, std::vector<int>& out) const {
-  if (!state_ || !state_->tree) {
+void KD::radius(int idx, float r, std::vector<int>& out, int max_nn, std::vector<float>* sqr_distances) const {
+  if (!state_ || (!state_->tree && !state_->brute)) {
     throw std::runtime_error("KD tree state not initialized");
   }
   if (idx < 0 || static_cast<std::size_t>(idx) >= state_->input_cloud->size()) {
     throw std::out_of_range("Query index out of bounds");
   }
-  if (r <= 0.0f) {
-    out.clear();
+  radius((*state_->input_cloud)[static_cast<std::size_t>(idx)], r, out, max_nn, sqr_distances);
+}
+
+void KD::radius(const PointT& query, float r, std::vector<int>& out, int max_nn,
+                std::vector<float>* sqr_distances) const {
+  if (!state_ || (!state_->tree && !state_->brute)) {
+    throw std::runtime_error("KD tree state not initialized");
+  }
+  if (state_->brute) {
+    state_->brute->radius(query, r, out, max_nn, sqr_distances);
     return;
   }
-
   out.clear();
-  std::vector<float> distances;
-  const bool ok = state_->tree->radiusSearch(idx, static_cast<double>(r), out, distances);
+  if (sqr_distances) {
+    sqr_distances->clear();
+  }
+  if (r <= 0.0f || !pcl::isFinite(query)) {
+    return;
+  }
+
+  // PCL always fills distances; reuse this thread's buffer when the caller does not want them.
+  thread_local std::vector<float> scratch;
+  std::vector<float>& distances = sqr_distances ? *sqr_distances : scratch;
+  const bool ok = state_->tree->radiusSearch(query, static_cast<double>(r), out, distances,
+                                             static_cast<unsigned int>(std::max(max_nn, 0)));
   if (!ok) {
     out.clear();
+    distances.clear();
+  }
+}
+
+void KD::knn(int idx, int k, std::vector<int>& out, std::vector<float>* sqr_distances) const {
+  if (!state_ || (!state_->tree && !state_->brute)) {
+    throw std::runtime_error("KD tree state not initialized");
+  }
+  if (idx < 0 || static_cast<std::size_t>(idx) >= state_->input_cloud->size()) {
+    throw std::out_of_range("Query index out of bounds");
+  }
+  knn((*state_->input_cloud)[static_cast<std::size_t>(idx)], k, out, sqr_distances);
+}
+
+void KD::knn(const PointT& query, int k, std::vector<int>& out, std::vector<float>* sqr_distances) const {
+  if (!state_ || (!state_->tree && !state_->brute)) {
+    throw std::runtime_error("KD tree state not initialized");
+  }
+  if (state_->brute) {
+    state_->brute->knn(query, k, out, sqr_distances);
+    return;
+  }
+  out.clear();
+  thread_local std::vector<float> scratch;
+  std::vector<float>& distances = sqr_distances ? *sqr_distances : scratch;
+  distances.clear();
+  if (k > 0 && pcl::isFinite(query)) {
+    state_->tree->nearestKSearch(query, k, out, distances);
   }
 }
 
@@ -0,0 +1,322 @@
+#include "m2c/kdtree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "m2c/brute_force.h"
+
+namespace m2c {
+namespace {
+
+constexpr int kLeafSize = 16;
+constexpr int kPollPoints = 16384;  // Subtrees at least this large poll before they split.
+
+struct Node {
+  float lo[3];
+  float hi[3];
+  int begin;  // Range of KD::State::order owned by the node.
+  int end;
+  int left;   // Child node ids; -1 for leaves.
+  int right;
+};
+
+}  // namespace
+
+// Built-in kd-tree for M2C_CORE_ONLY builds: median splits on the widest axis, leaves of up to
+// kLeafSize points whose coordinates are packed contiguously for the distance scans. Small clouds
+// skip the tree and scan a BruteForceIndex instead.
+struct KD::State {
+  SearchBackend backend = SearchBackend::Tree;
+  std::unique_ptr<BruteForceIndex> brute;
+  const CloudT* cloud = nullptr;  // Query coordinates for the brute-force backend.
+  std::size_t cloud_size = 0;
+  std::vector<int> order;   // Point ids permuted so every node owns a contiguous range.
+  std::vector<float> xyz;   // Coordinates in `order` order.
+  std::vector<int> slot;    // Point id -> position in `order` (-1 for non-finite points).
+  std::vector<Node> nodes;
+
+  int build(const CloudT& cloud, int begin, int end, const std::function<void()>& poll) {
+    if (poll && end - begin >= kPollPoints) poll();
+    Node node;
+    for (int axis = 0; axis < 3; ++axis) {
+      node.lo[axis] = std::numeric_limits<float>::max();
+      node.hi[axis] = std::numeric_limits<float>::lowest();
+    }
+    for (int i = begin; i < end; ++i) {
+      const PointT& p = cloud[static_cast<std::size_t>(order[i])];
+      const float c[3] = {p.x, p.y, p.z};
+      for (int axis = 0; axis < 3; ++axis) {
+        node.lo[axis] = std::min(node.lo[axis], c[axis]);
+        node.hi[axis] = std::max(node.hi[axis], c[axis]);
+      }
+    }
+    node.begin = begin;
+    node.end = end;
+    node.left = node.right = -1;
+    const int id = static_cast<int>(nodes.size());
+    nodes.push_back(node);
+    if (end - begin <= kLeafSize) {
+      return id;
+    }
+
+    int axis = 0;
+    for (int a = 1; a < 3; ++a) {
+      if (node.hi[a] - node.lo[a] > node.hi[axis] - node.lo[axis]) axis = a;
+    }
+    const int mid = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [&](int a, int b) {
+      const PointT& pa = cloud[static_cast<std::size_t>(a)];
+      const PointT& pb = cloud[static_cast<std::size_t>(b)];
+      return (axis == 0 ? pa.x : axis == 1 ? pa.y : pa.z) < (axis == 0 ? pb.x : axis == 1 ? pb.y : pb.z);
+    });
+    const int left = build(cloud, begin, mid, poll);
+    const int right = build(cloud, mid, end, poll);
+    nodes[static_cast<std::size_t>(id)].left = left;
+    nodes[static_cast<std::size_t>(id)].right = right;
+    return id;
+  }
+
+  // Neighbors of coordinates `q` (nullptr: a non-finite query, which has none).
+  void radius(const float* q, float r, std::vector<int>& out, int max_nn, std::vector<float>* sqr_distances) const {
+    out.clear();
+    if (sqr_distances) {
+      sqr_distances->clear();
+    }
+    if (r <= 0.0f || !q || nodes.empty()) {
+      return;
+    }
+
+    const float r2 = r * r;
+    thread_local std::vector<std::pair<float, int>> hits;
+    thread_local std::vector<int> stack;
+    hits.clear();
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty()) {
+      const Node& node = nodes[static_cast<std::size_t>(stack.back())];
+      stack.pop_back();
+      float box = 0.0f;
+      for (int axis = 0; axis < 3; ++axis) {
+        const float d = std::max({node.lo[axis] - q[axis], 0.0f, q[axis] - node.hi[axis]});
+        box += d * d;
+      }
+      if (box > r2) {
+        continue;
+      }
+      if (node.left >= 0) {
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+        continue;
+      }
+      for (int k = node.begin; k < node.end; ++k) {
+        const float dx = xyz[3 * k] - q[0];
+        const float dy = xyz[3 * k + 1] - q[1];
+        const float dz = xyz[3 * k + 2] - q[2];
+        const float d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 <= r2) {
+          hits.emplace_back(d2, order[static_cast<std::size_t>(k)]);
+        }
+      }
+    }
+
+    // Same contract as PCL's sorted radiusSearch: nearest first, optionally truncated.
+    std::size_t keep = hits.size();
+    if (max_nn > 0 && static_cast<std::size_t>(max_nn) < keep) {
+      keep = static_cast<std::size_t>(max_nn);
+      std::partial_sort(hits.begin(), hits.begin() + static_cast<std::ptrdiff_t>(keep), hits.end());
+    } else {
+      std::sort(hits.begin(), hits.end());
+    }
+    out.reserve(keep);
+    for (std::size_t i = 0; i < keep; ++i) {
+      out.push_back(hits[i].second);
+      if (sqr_distances) {
+        sqr_distances->push_back(hits[i].first);
+      }
+    }
+  }
+
+  void knn(const float* q, int k, std::vector<int>& out, std::vector<float>* sqr_distances) const {
+    out.clear();
+    if (sqr_distances) {
+      sqr_distances->clear();
+    }
+    if (k <= 0 || !q || nodes.empty()) {
+      return;
+    }
+
+    // Depth-first with the nearer child first; `best` is a max-heap on distance capped at k entries.
+    const std::size_t cap = static_cast<std::size_t>(k);
+    thread_local std::vector<std::pair<float, int>> best;
+    thread_local std::vector<std::pair<float, int>> stack;  // (box distance, node)
+    best.clear();
+    stack.clear();
+    const auto boxDistance = [q](const Node& node) {
+      float box = 0.0f;
+      for (int axis = 0; axis < 3; ++axis) {
+        const float d = std::max({node.lo[axis] - q[axis], 0.0f, q[axis] - node.hi[axis]});
+        box += d * d;
+      }
+      return box;
+    };
+    stack.emplace_back(0.0f, 0);
+    while (!stack.empty()) {
+      const std::pair<float, int> top = stack.back();
+      stack.pop_back();
+      if (best.size() == cap && top.first > best.front().first) {
+        continue;
+      }
+      const Node& node = nodes[static_cast<std::size_t>(top.second)];
+      if (node.left >= 0) {
+        const float dl = boxDistance(nodes[static_cast<std::size_t>(node.left)]);
+        const float dr = boxDistance(nodes[static_cast<std::size_t>(node.right)]);
+        // Push the farther child first so the nearer one is visited next.
+        if (dl < dr) {
+          stack.emplace_back(dr, node.right);
+          stack.emplace_back(dl, node.left);
+        } else {
+          stack.emplace_back(dl, node.left);
+          stack.emplace_back(dr, node.right);
+        }
+        continue;
+      }
+      for (int j = node.begin; j < node.end; ++j) {
+        const float dx = xyz[3 * j] - q[0];
+        const float dy = xyz[3 * j + 1] - q[1];
+        const float dz = xyz[3 * j + 2] - q[2];
+        const float d2 = dx * dx + dy * dy + dz * dz;
+        // Ties at the k-th distance go to the lower index, as in the brute-force backend.
+        const std::pair<float, int> hit(d2, order[static_cast<std::size_t>(j)]);
+        if (best.size() < cap) {
+          best.push_back(hit);
+          std::push_heap(best.begin(), best.end());
+        } else if (hit < best.front()) {
+          std::pop_heap(best.begin(), best.end());
+          best.back() = hit;
+          std::push_heap(best.begin(), best.end());
+        }
+      }
+    }
+
+    std::sort_heap(best.begin(), best.end());
+    out.reserve(best.size());
+    for (const auto& hit : best) {
+      out.push_back(hit.second);
+      if (sqr_distances) {
+        sqr_distances->push_back(hit.first);
+      }
+    }
+  }
+};
+
+KD::KD(const CloudT& cloud, const KDOptions& options) : state_(std::make_shared<State>()) {
+  if (cloud.empty()) {
+    throw std::invalid_argument("Cannot build KDTree on an empty cloud");
+  }
+
+  State& s = *state_;
+  s.cloud_size = cloud.size();
+  s.backend = chooseSearchBackend(cloud, options);
+  if (options.poll) options.poll();
+  if (s.backend == SearchBackend::BruteForce) {
+    s.brute.reset(new BruteForceIndex(cloud));
+    s.cloud = &cloud;
+    return;
+  }
+  s.slot.assign(cloud.size(), -1);
+  s.order.reserve(cloud.size());
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    const PointT& p = cloud[i];
+    if (std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z)) {
+      s.order.push_back(static_cast<int>(i));
+    }
+  }
+  if (!s.order.empty()) {
+    s.nodes.reserve(2 * s.order.size() / kLeafSize + 1);
+    s.build(cloud, 0, static_cast<int>(s.order.size()), options.poll);
+  }
+  s.xyz.resize(3 * s.order.size());
+  for (std::size_t k = 0; k < s.order.size(); ++k) {
+    const PointT& p = cloud[static_cast<std::size_t>(s.order[k])];
+    s.xyz[3 * k] = p.x;
+    s.xyz[3 * k + 1] = p.y;
+    s.xyz[3 * k + 2] = p.z;
+    s.slot[static_cast<std::size_t>(s.order[k])] = static_cast<int>(k);
+  }
+}
+
+SearchBackend KD::backend() const {
+  return state_ ? state_->backend : SearchBackend::Tree;
+}
+
+std::size_t KD::size() const {
+  return state_ ? state_->cloud_size : 0;
+}
+
+void KD::radius(int idx, float r, std::vector<int>& out, int max_nn, std::vector<float>* sqr_distances) const {
+  if (!state_) {
+    throw std::runtime_error("KD tree state not initialized");
+  }
+  const State& s = *state_;
+  if (idx < 0 || static_cast<std::size_t>(idx) >= s.cloud_size) {
+    throw std::out_of_range("Query index out of bounds");
+  }
+  if (s.brute) {
+    s.brute->radius((*s.cloud)[static_cast<std::size_t>(idx)], r, out, max_nn, sqr_distances);
+    return;
+  }
+  const int at = s.slot[static_cast<std::size_t>(idx)];
+  s.radius(at < 0 ? nullptr : &s.xyz[3 * static_cast<std::size_t>(at)], r, out, max_nn, sqr_distances);
+}
+
+void KD::radius(const PointT& query, float r, std::vector<int>& out, int max_nn,
+                std::vector<float>* sqr_distances) const {
+  if (!state_) {
+    throw std::runtime_error("KD tree state not initialized");
+  }
+  const State& s = *state_;
+  if (s.brute) {
+    s.brute->radius(query, r, out, max_nn, sqr_distances);
+    return;
+  }
+  const float q[3] = {query.x, query.y, query.z};
+  const bool finite = std::isfinite(q[0]) && std::isfinite(q[1]) && std::isfinite(q[2]);
+  s.radius(finite ? q : nullptr, r, out, max_nn, sqr_distances);
+}
+
+void KD::knn(int idx, int k, std::vector<int>& out, std::vector<float>* sqr_distances) const {
+  if (!state_) {
+    throw std::runtime_error("KD tree state not initialized");
+  }
+  const State& s = *state_;
+  if (idx < 0 || static_cast<std::size_t>(idx) >= s.cloud_size) {
+    throw std::out_of_range("Query index out of bounds");
+  }
+  if (s.brute) {
+    s.brute->knn((*s.cloud)[static_cast<std::size_t>(idx)], k, out, sqr_distances);
+    return;
+  }
+  const int at = s.slot[static_cast<std::size_t>(idx)];
+  s.knn(at < 0 ? nullptr : &s.xyz[3 * static_cast<std::size_t>(at)], k, out, sqr_distances);
+}
+
+void KD::knn(const PointT& query, int k, std::vector<int>& out, std::vector<float>* sqr_distances) const {
+  if (!state_) {
+    throw std::runtime_error("KD tree state not initialized");
+  }
+  const State& s = *state_;
+  if (s.brute) {
+    s.brute->knn(query, k, out, sqr_distances);
+    return;
+  }
+  const float q[3] = {query.x, query.y, query.z};
+  const bool finite = std::isfinite(q[0]) && std::isfinite(q[1]) && std::isfinite(q[2]);
+  s.knn(finite ? q : nullptr, k, out, sqr_distances);
+}
+
+}  // namespace m2c
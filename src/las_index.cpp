@@ -0,0 +1,623 @@
+#include "m2c/las_index.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "m2c/trace.h"
+
+namespace m2c {
+namespace {
+
+constexpr char kMagic[4] = {'M', '2', 'C', 'I'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kBlockBytes = std::size_t(8) << 20;
+constexpr std::size_t kMaxCells = std::size_t(1) << 24;
+
+// LAS is little-endian on disk; decode byte by byte so the host order does not matter.
+std::uint16_t u16le(const unsigned char* p) {
+  return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+std::uint32_t u32le(const unsigned char* p) {
+  return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+         (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+std::uint64_t u64le(const unsigned char* p) {
+  return static_cast<std::uint64_t>(u32le(p)) | (static_cast<std::uint64_t>(u32le(p + 4)) << 32);
+}
+
+double f64le(const unsigned char* p) {
+  const std::uint64_t bits = u64le(p);
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+class Fd {
+ public:
+  Fd(const std::string& path, int flags, mode_t mode = 0) : path_(path) {
+    fd_ = ::open(path.c_str(), flags, mode);
+    if (fd_ < 0) {
+      throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+    }
+  }
+
+  ~Fd() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  Fd(const Fd&) = delete;
+  Fd& operator=(const Fd&) = delete;
+
+  void readAt(void* data, std::size_t bytes, std::uint64_t offset) const {
+    char* out = static_cast<char*>(data);
+    while (bytes > 0) {
+      const ssize_t got = ::pread(fd_, out, bytes, static_cast<off_t>(offset));
+      if (got < 0 && errno == EINTR) {
+        continue;
+      }
+      if (got <= 0) {
+        const std::string reason = got == 0 ? "unexpected end of file" : std::strerror(errno);
+        throw std::runtime_error("Failed to read " + path_ + ": " + reason);
+      }
+      out += got;
+      bytes -= static_cast<std::size_t>(got);
+      offset += static_cast<std::uint64_t>(got);
+    }
+  }
+
+  void writeAt(const void* data, std::size_t bytes, std::uint64_t offset) const {
+    const char* in = static_cast<const char*>(data);
+    while (bytes > 0) {
+      const ssize_t put = ::pwrite(fd_, in, bytes, static_cast<off_t>(offset));
+      if (put < 0 && errno == EINTR) {
+        continue;
+      }
+      if (put < 0) {
+        throw std::runtime_error("Failed to write " + path_ + ": " + std::strerror(errno));
+      }
+      in += put;
+      bytes -= static_cast<std::size_t>(put);
+      offset += static_cast<std::uint64_t>(put);
+    }
+  }
+
+  std::uint64_t size() const {
+    struct stat info;
+    if (::fstat(fd_, &info) != 0) {
+      throw std::runtime_error("Failed to stat " + path_ + ": " + std::strerror(errno));
+    }
+    return static_cast<std::uint64_t>(info.st_size);
+  }
+
+  void close() {
+    const int rc = ::close(fd_);
+    fd_ = -1;
+    if (rc != 0) {
+      throw std::runtime_error("Failed to close " + path_ + ": " + std::strerror(errno));
+    }
+  }
+
+ private:
+  std::string path_;
+  int fd_ = -1;
+};
+
+struct LasLayout {
+  std::uint64_t point_offset = 0;
+  std::uint64_t point_count = 0;
+  std::uint32_t record_length = 0;
+  unsigned format = 0;  // Point data record format (0-10); not stored in the sidecar.
+  bool compressed = false;
+  double scale[3] = {1.0, 1.0, 1.0};
+  double offset[3] = {0.0, 0.0, 0.0};
+
+  std::uint64_t pointEnd() const { return point_offset + point_count * record_length; }
+
+  // Every point data record format starts with int32 X, Y, Z.
+  void decode(const unsigned char* record, double xyz[3]) const {
+    for (int axis = 0; axis < 3; ++axis) {
+      xyz[axis] = static_cast<std::int32_t>(u32le(record + 4 * axis)) * scale[axis] + offset[axis];
+    }
+  }
+
+  // Byte offset of the RGB triple, or 0 for formats without color.
+  std::size_t colorOffset() const {
+    switch (format) {
+      case 2: return 20;
+      case 3: case 5: return 28;
+      case 7: case 8: case 10: return 30;
+      default: return 0;
+    }
+  }
+
+  // Byte offset of the GPS time, or 0 for formats without it (0 and 2).
+  std::size_t gpsTimeOffset() const {
+    switch (format) {
+      case 1: case 3: case 4: case 5: return 20;
+      case 6: case 7: case 8: case 9: case 10: return 22;
+      default: return 0;
+    }
+  }
+
+  void startAttributes(PointAttributes& out) const {
+    out.clear();
+    out.color_bits = 16;
+  }
+
+  // Intensity sits at byte 12 in every format; classification is the low 5 bits of byte 15 in the
+  // legacy formats 0-5 and all of byte 16 in formats 6-10.
+  void decodeAttributes(const unsigned char* record, PointAttributes& out) const {
+    if (record_length < 17) {
+      return;  // Shorter than any standard format: XYZ only.
+    }
+    out.intensity.push_back(u16le(record + 12));
+    out.classification.push_back(format >= 6 ? record[16] : static_cast<std::uint8_t>(record[15] & 0x1F));
+    const std::size_t rgb = colorOffset();
+    if (rgb != 0 && record_length >= rgb + 6) {
+      out.red.push_back(u16le(record + rgb));
+      out.green.push_back(u16le(record + rgb + 2));
+      out.blue.push_back(u16le(record + rgb + 4));
+    }
+    const std::size_t gps = gpsTimeOffset();
+    if (out.scan_order && gps != 0 && record_length >= gps + 8) {
+      // Formats 6-10 store the angle as int16 in 0.006 degree steps, the legacy ones as int8 degrees.
+      out.scan_angle.push_back(format >= 6 ? static_cast<std::int16_t>(u16le(record + 18)) * 0.006f
+                                           : static_cast<float>(static_cast<std::int8_t>(record[16])));
+      out.gps_time.push_back(f64le(record + gps));
+    }
+  }
+};
+
+LasLayout readLayout(const Fd& file, const std::string& path, bool allow_compressed = false) {
+  unsigned char header[375] = {};
+  const std::uint64_t file_size = file.size();
+  if (file_size < 227) {
+    throw std::runtime_error("Not a LAS file (header too short): " + path);
+  }
+  file.readAt(header, static_cast<std::size_t>(std::min<std::uint64_t>(file_size, sizeof(header))), 0);
+  if (std::memcmp(header, "LASF", 4) != 0) {
+    throw std::runtime_error("Not a LAS file (missing LASF signature): " + path);
+  }
+
+  LasLayout layout;
+  const unsigned minor = header[25];
+  const std::uint16_t header_size = u16le(header + 94);
+  layout.point_offset = u32le(header + 96);
+  const unsigned format = header[104];
+  layout.format = format & 0x3F;
+  layout.compressed = (format & 0xC0) != 0;
+  layout.point_count = u32le(header + 107);
+  if (minor >= 4 && header_size >= 375 && file_size >= 375) {
+    const std::uint64_t count = u64le(header + 247);
+    if (count != 0) {
+      layout.point_count = count;
+    }
+  }
+  if (layout.compressed) {
+    if (allow_compressed) {
+      return layout;
+    }
+    throw std::runtime_error("Compressed (LAZ) point records cannot be indexed; decompress first: " + path);
+  }
+  layout.record_length = u16le(header + 105);
+  for (int axis = 0; axis < 3; ++axis) {
+    layout.scale[axis] = f64le(header + 131 + 8 * axis);
+    layout.offset[axis] = f64le(header + 155 + 8 * axis);
+  }
+  if (layout.record_length < 12) {
+    throw std::runtime_error("Invalid LAS point record length in " + path);
+  }
+  if (layout.pointEnd() > file_size) {
+    throw std::runtime_error("LAS point records extend past the end of " + path);
+  }
+  return layout;
+}
+
+// Visits every point record in file order, reading whole blocks at a time.
+template <typename Visit>
+void forEachRecord(const Fd& file, const LasLayout& layout, std::uint64_t begin, std::uint64_t end, Visit&& visit) {
+  const std::size_t per_block = std::max<std::size_t>(1, kBlockBytes / layout.record_length);
+  std::vector<unsigned char> block(
+      static_cast<std::size_t>(std::min<std::uint64_t>(per_block, end - begin)) * layout.record_length);
+  for (std::uint64_t first = begin; first < end; first += per_block) {
+    const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(per_block, end - first));
+    file.readAt(block.data(), count * layout.record_length, layout.point_offset + first * layout.record_length);
+    for (std::size_t i = 0; i < count; ++i) {
+      visit(block.data() + i * layout.record_length);
+    }
+  }
+}
+
+void copyRange(const Fd& from, const Fd& to, std::uint64_t begin, std::uint64_t end) {
+  std::vector<char> block(kBlockBytes);
+  for (std::uint64_t at = begin; at < end; at += block.size()) {
+    const std::size_t bytes = static_cast<std::size_t>(std::min<std::uint64_t>(block.size(), end - at));
+    from.readAt(block.data(), bytes, at);
+    to.writeAt(block.data(), bytes, at);
+  }
+}
+
+struct Grid {
+  double origin_x = 0.0;
+  double origin_y = 0.0;
+  double cell = 1.0;
+  std::uint32_t nx = 1;
+  std::uint32_t ny = 1;
+
+  std::size_t cells() const { return static_cast<std::size_t>(nx) * ny; }
+
+  std::uint32_t column(double x) const {
+    const double i = std::floor((x - origin_x) / cell);
+    return static_cast<std::uint32_t>(std::clamp(i, 0.0, static_cast<double>(nx - 1)));
+  }
+
+  std::uint32_t row(double y) const {
+    const double j = std::floor((y - origin_y) / cell);
+    return static_cast<std::uint32_t>(std::clamp(j, 0.0, static_cast<double>(ny - 1)));
+  }
+
+  std::size_t of(const double xyz[3]) const {
+    return static_cast<std::size_t>(row(xyz[1])) * nx + column(xyz[0]);
+  }
+};
+
+struct Sidecar {
+  std::uint64_t las_size = 0;
+  std::int64_t las_mtime = 0;
+  LasLayout layout;
+  Grid grid;
+  std::vector<std::uint64_t> begin;  // Record range of cell c: [begin[c], begin[c + 1]).
+  std::vector<float> zrange;         // zmin, zmax per cell.
+};
+
+std::int64_t mtimeOf(const std::string& path) {
+  return static_cast<std::int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+}
+
+template <typename T>
+void writePod(std::ofstream& output, const T& value) {
+  output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void readPod(std::ifstream& input, T& value) {
+  input.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+void saveSidecar(const std::string& path, const Sidecar& index) {
+  std::ofstream output(path, std::ios::binary | std::ios::trunc);
+  if (!output) {
+    throw std::runtime_error("Failed to open LAS index for writing: " + path);
+  }
+  output.write(kMagic, sizeof(kMagic));
+  writePod(output, kVersion);
+  writePod(output, index.las_size);
+  writePod(output, index.las_mtime);
+  writePod(output, index.layout.point_offset);
+  writePod(output, index.layout.point_count);
+  writePod(output, index.layout.record_length);
+  for (int axis = 0; axis < 3; ++axis) {
+    writePod(output, index.layout.scale[axis]);
+    writePod(output, index.layout.offset[axis]);
+  }
+  writePod(output, index.grid.origin_x);
+  writePod(output, index.grid.origin_y);
+  writePod(output, index.grid.cell);
+  writePod(output, index.grid.nx);
+  writePod(output, index.grid.ny);
+  output.write(reinterpret_cast<const char*>(index.begin.data()),
+               static_cast<std::streamsize>(index.begin.size() * sizeof(std::uint64_t)));
+  output.write(reinterpret_cast<const char*>(index.zrange.data()),
+               static_cast<std::streamsize>(index.zrange.size() * sizeof(float)));
+  if (!output) {
+    throw std::runtime_error("Failed to write LAS index: " + path);
+  }
+}
+
+Sidecar loadSidecar(const std::string& path) {
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    throw std::runtime_error("Failed to open LAS index: " + path);
+  }
+  char magic[4] = {};
+  std::uint32_t version = 0;
+  input.read(magic, sizeof(magic));
+  readPod(input, version);
+  if (!input || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || version != kVersion) {
+    throw std::runtime_error("Not a mask2cluster LAS index (or unsupported version): " + path);
+  }
+
+  Sidecar index;
+  readPod(input, index.las_size);
+  readPod(input, index.las_mtime);
+  readPod(input, index.layout.point_offset);
+  readPod(input, index.layout.point_count);
+  readPod(input, index.layout.record_length);
+  for (int axis = 0; axis < 3; ++axis) {
+    readPod(input, index.layout.scale[axis]);
+    readPod(input, index.layout.offset[axis]);
+  }
+  readPod(input, index.grid.origin_x);
+  readPod(input, index.grid.origin_y);
+  readPod(input, index.grid.cell);
+  readPod(input, index.grid.nx);
+  readPod(input, index.grid.ny);
+  if (!input || index.grid.nx == 0 || index.grid.ny == 0 || index.grid.cells() > kMaxCells) {
+    throw std::runtime_error("Corrupt LAS index header: " + path);
+  }
+  index.begin.resize(index.grid.cells() + 1);
+  index.zrange.resize(2 * index.grid.cells());
+  input.read(reinterpret_cast<char*>(index.begin.data()),
+             static_cast<std::streamsize>(index.begin.size() * sizeof(std::uint64_t)));
+  input.read(reinterpret_cast<char*>(index.zrange.data()),
+             static_cast<std::streamsize>(index.zrange.size() * sizeof(float)));
+  if (!input || index.begin.back() != index.layout.point_count) {
+    throw std::runtime_error("Corrupt LAS index body: " + path);
+  }
+  return index;
+}
+
+}  // namespace
+
+bool forEachLasChunk(const std::string& las_path,
+                     std::size_t chunk_points,
+                     const std::function<void(const CloudT&)>& callback,
+                     PointAttributes* attributes) {
+  M2C_TRACE_SCOPE("forEachLasChunk");
+  Fd input(las_path, O_RDONLY);
+  const LasLayout layout = readLayout(input, las_path, true);
+  if (layout.compressed) {
+    return false;
+  }
+
+  chunk_points = std::max<std::size_t>(1, chunk_points);
+  CloudT chunk;
+  chunk.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(chunk_points, layout.point_count)));
+  const auto emit = [&]() {
+    chunk.width = static_cast<std::uint32_t>(chunk.size());
+    chunk.height = 1;
+    chunk.is_dense = false;
+    callback(chunk);
+    chunk.clear();
+    if (attributes) layout.startAttributes(*attributes);
+  };
+  if (attributes) layout.startAttributes(*attributes);
+  double xyz[3];
+  forEachRecord(input, layout, 0, layout.point_count, [&](const unsigned char* record) {
+    layout.decode(record, xyz);
+    chunk.push_back(PointT(static_cast<float>(xyz[0]), static_cast<float>(xyz[1]), static_cast<float>(xyz[2])));
+    if (attributes) layout.decodeAttributes(record, *attributes);
+    if (chunk.size() >= chunk_points) {
+      emit();
+    }
+  });
+  if (!chunk.empty()) {
+    emit();
+  }
+  return true;
+}
+
+std::uint64_t lasPointCount(const std::string& las_path) {
+  Fd input(las_path, O_RDONLY);
+  return readLayout(input, las_path, true).point_count;
+}
+
+std::string lasIndexPath(const std::string& las_path) {
+  return las_path + ".m2ci";
+}
+
+LasIndexSummary buildLasIndex(const std::string& las_path, const LasIndexOptions& options) {
+  M2C_TRACE_SCOPE("buildLasIndex");
+  Sidecar index;
+  const std::string tmp_path = las_path + ".reorder.tmp";
+  {
+    Fd input(las_path, O_RDONLY);
+    const LasLayout layout = readLayout(input, las_path);
+    const std::uint64_t file_size = input.size();
+    index.layout = layout;
+
+    // Pass 1: exact XY bounds (header bounds are not always trustworthy).
+    double min_x = std::numeric_limits<double>::max();
+    double min_y = std::numeric_limits<double>::max();
+    double max_x = std::numeric_limits<double>::lowest();
+    double max_y = std::numeric_limits<double>::lowest();
+    double xyz[3];
+    forEachRecord(input, layout, 0, layout.point_count, [&](const unsigned char* record) {
+      layout.decode(record, xyz);
+      min_x = std::min(min_x, xyz[0]);
+      min_y = std::min(min_y, xyz[1]);
+      max_x = std::max(max_x, xyz[0]);
+      max_y = std::max(max_y, xyz[1]);
+    });
+
+    Grid& grid = index.grid;
+    if (layout.point_count > 0) {
+      const double width = std::max(max_x - min_x, 1e-3);
+      const double height = std::max(max_y - min_y, 1e-3);
+      grid.origin_x = min_x;
+      grid.origin_y = min_y;
+      grid.cell = options.cell > 0.0f
+                      ? static_cast<double>(options.cell)
+                      : std::sqrt(width * height * static_cast<double>(std::max<std::size_t>(1, options.points_per_cell)) /
+                                  static_cast<double>(layout.point_count));
+      grid.cell = std::max(grid.cell, 1e-3);
+      while ((std::floor(width / grid.cell) + 1.0) * (std::floor(height / grid.cell) + 1.0) > static_cast<double>(kMaxCells)) {
+        grid.cell *= 2.0;
+      }
+      grid.nx = static_cast<std::uint32_t>(std::floor(width / grid.cell)) + 1;
+      grid.ny = static_cast<std::uint32_t>(std::floor(height / grid.cell)) + 1;
+    }
+
+    // Pass 2: cell occupancy and z extent.
+    std::vector<std::uint64_t> counts(grid.cells(), 0);
+    index.zrange.assign(2 * grid.cells(), 0.0f);
+    std::vector<double> zmin(grid.cells(), std::numeric_limits<double>::max());
+    std::vector<double> zmax(grid.cells(), std::numeric_limits<double>::lowest());
+    forEachRecord(input, layout, 0, layout.point_count, [&](const unsigned char* record) {
+      layout.decode(record, xyz);
+      const std::size_t cell = grid.of(xyz);
+      ++counts[cell];
+      zmin[cell] = std::min(zmin[cell], xyz[2]);
+      zmax[cell] = std::max(zmax[cell], xyz[2]);
+    });
+    index.begin.assign(grid.cells() + 1, 0);
+    std::vector<int> slot(grid.cells(), -1);
+    int occupied = 0;
+    for (std::size_t c = 0; c < grid.cells(); ++c) {
+      index.begin[c + 1] = index.begin[c] + counts[c];
+      if (counts[c] > 0) {
+        slot[c] = occupied++;
+        // Rounded outward so float extents still contain every double coordinate.
+        index.zrange[2 * c] = std::nextafter(static_cast<float>(zmin[c]), -std::numeric_limits<float>::infinity());
+        index.zrange[2 * c + 1] = std::nextafter(static_cast<float>(zmax[c]), std::numeric_limits<float>::infinity());
+      }
+    }
+
+    // Pass 3: scatter records into their cell's range of a copy, batching pwrites per cell.
+    struct stat info;
+    const mode_t mode = ::stat(las_path.c_str(), &info) == 0 ? (info.st_mode & 0777) : 0644;
+    Fd output(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, mode);
+    try {
+      copyRange(input, output, 0, layout.point_offset);
+      copyRange(input, output, layout.pointEnd(), file_size);
+
+      const std::size_t length = layout.record_length;
+      const std::size_t capacity =
+          std::max<std::size_t>(1, options.buffer_bytes / (std::max(occupied, 1) * length));
+      std::vector<unsigned char> arena(static_cast<std::size_t>(occupied) * capacity * length);
+      std::vector<std::size_t> fill(static_cast<std::size_t>(occupied), 0);
+      std::vector<std::uint64_t> cursor(index.begin.begin(), index.begin.end() - 1);
+      const auto flush = [&](std::size_t cell) {
+        const std::size_t s = static_cast<std::size_t>(slot[cell]);
+        output.writeAt(arena.data() + s * capacity * length, fill[s] * length,
+                       layout.point_offset + cursor[cell] * length);
+        cursor[cell] += fill[s];
+        fill[s] = 0;
+      };
+      forEachRecord(input, layout, 0, layout.point_count, [&](const unsigned char* record) {
+        layout.decode(record, xyz);
+        const std::size_t cell = grid.of(xyz);
+        const std::size_t s = static_cast<std::size_t>(slot[cell]);
+        std::memcpy(arena.data() + (s * capacity + fill[s]) * length, record, length);
+        if (++fill[s] == capacity) {
+          flush(cell);
+        }
+      });
+      for (std::size_t c = 0; c < grid.cells(); ++c) {
+        if (slot[c] >= 0 && fill[static_cast<std::size_t>(slot[c])] > 0) {
+          flush(c);
+        }
+      }
+      output.close();
+    } catch (...) {
+      std::remove(tmp_path.c_str());
+      throw;
+    }
+  }
+
+  if (std::rename(tmp_path.c_str(), las_path.c_str()) != 0) {
+    const std::string reason = std::strerror(errno);
+    std::remove(tmp_path.c_str());
+    throw std::runtime_error("Failed to replace " + las_path + " with its reordered copy: " + reason);
+  }
+  index.las_size = std::filesystem::file_size(las_path);
+  index.las_mtime = mtimeOf(las_path);
+  saveSidecar(lasIndexPath(las_path), index);
+
+  LasIndexSummary summary;
+  summary.points = index.layout.point_count;
+  summary.cell = static_cast<float>(index.grid.cell);
+  summary.nx = index.grid.nx;
+  summary.ny = index.grid.ny;
+  for (std::size_t c = 0; c < index.grid.cells(); ++c) {
+    summary.occupied += index.begin[c + 1] > index.begin[c] ? 1 : 0;
+  }
+  return summary;
+}
+
+CloudT::Ptr loadLasRegion(const std::string& las_path, const Roi& roi, PointAttributes* attributes) {
+  M2C_TRACE_SCOPE("loadLasRegion");
+  const std::string sidecar_path = lasIndexPath(las_path);
+  std::error_code ec;
+  if (!std::filesystem::exists(sidecar_path, ec)) {
+    return nullptr;
+  }
+  const Sidecar index = loadSidecar(sidecar_path);
+  if (std::filesystem::file_size(las_path) != index.las_size || mtimeOf(las_path) != index.las_mtime) {
+    return nullptr;  // LAS changed after indexing; the record ranges are no longer valid.
+  }
+
+  const Grid& grid = index.grid;
+  const double cx = roi.center.x();
+  const double cy = roi.center.y();
+  const double cz = roi.center.z();
+  const double r = std::max(0.0f, roi.radius);
+
+  // Record ranges of the cells whose box touches the sphere; row-adjacent cells are contiguous.
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> ranges;
+  const std::uint32_t i0 = grid.column(cx - r), i1 = grid.column(cx + r);
+  const std::uint32_t j0 = grid.row(cy - r), j1 = grid.row(cy + r);
+  for (std::uint32_t j = j0; j <= j1; ++j) {
+    for (std::uint32_t i = i0; i <= i1; ++i) {
+      const std::size_t c = static_cast<std::size_t>(j) * grid.nx + i;
+      if (index.begin[c + 1] == index.begin[c]) {
+        continue;
+      }
+      const double x_lo = grid.origin_x + i * grid.cell, y_lo = grid.origin_y + j * grid.cell;
+      const double dx = std::max({x_lo - cx, 0.0, cx - (x_lo + grid.cell)});
+      const double dy = std::max({y_lo - cy, 0.0, cy - (y_lo + grid.cell)});
+      const double dz = std::max({static_cast<double>(index.zrange[2 * c]) - cz, 0.0,
+                                  cz - static_cast<double>(index.zrange[2 * c + 1])});
+      if (dx * dx + dy * dy + dz * dz > r * r) {
+        continue;
+      }
+      if (!ranges.empty() && ranges.back().second == index.begin[c]) {
+        ranges.back().second = index.begin[c + 1];
+      } else {
+        ranges.emplace_back(index.begin[c], index.begin[c + 1]);
+      }
+    }
+  }
+
+  Fd input(las_path, O_RDONLY);
+  LasLayout layout = index.layout;
+  if (attributes) {
+    layout.format = readLayout(input, las_path).format;
+    layout.startAttributes(*attributes);
+  }
+  CloudT::Ptr cloud(new CloudT);
+  double xyz[3];
+  for (const auto& range : ranges) {
+    forEachRecord(input, layout, range.first, range.second, [&](const unsigned char* record) {
+      layout.decode(record, xyz);
+      const double dx = xyz[0] - cx, dy = xyz[1] - cy, dz = xyz[2] - cz;
+      if (dx * dx + dy * dy + dz * dz <= r * r) {
+        cloud->push_back(PointT(static_cast<float>(xyz[0]), static_cast<float>(xyz[1]), static_cast<float>(xyz[2])));
+        if (attributes) layout.decodeAttributes(record, *attributes);
+      }
+    });
+  }
+  cloud->width = static_cast<std::uint32_t>(cloud->size());
+  cloud->height = 1;
+  cloud->is_dense = false;
+  return cloud;
+}
+
+}  // namespace m2c
@@ -1,17 +1,27 @@
 #include "m2c/pipeline.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <functional>
 #include <limits>
+#include <optional>
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
-#include <pcl/PointIndices.h>
-
+#include "m2c/cluster_stats.h"
+#include "m2c/deadline.h"
+#include "m2c/eps_estimate.h"
+#include "m2c/incremental.h"
 #include "m2c/kdtree.h"
+#include "m2c/scan_grid.h"
+#include "m2c/trace.h"
 #include "m2c/validator.h"
+#include "m2c/voxel_grid.h"
+#include "m2c/voxelcc.h"
 #include "pcg/FEC.hpp"
 
 namespace m2c {
@@ -22,127 +32,524 @@ struct Candidate {
   float distance;
 };
 
-}  // namespace
+using Poll = std::function<void()>;
 
-Result selectCluster(const CloudT& cloud, const Pose& pose, const Params& params) {
-  Result result;
+constexpr double kCoarseShare = 0.25;           // Share of the budget the coarse tier always gets.
+constexpr std::size_t kLocalEpsPoints = 65536;  // Crop around C for a fallback eps estimate.
 
-  if (cloud.empty()) {
-    return result;
-  }
+// Index options with the configured backend crossovers; callers add radius_hint and poll.
+KDOptions kdOptions(const Params& params) {
+  KDOptions options;
+  options.brute_force_max_points = static_cast<std::size_t>(std::max(0, params.kd_brute_force_max_points));
+  options.brute_force_min_coverage = params.kd_brute_force_min_coverage;
+  options.compact_max_points = static_cast<std::size_t>(std::max(0, params.kd_compact_max_points));
+  return options;
+}
 
-  // 1) FEC clustering on the full (possibly downsampled) cloud
-  CloudT::Ptr cloud_ptr(const_cast<CloudT*>(&cloud), [](CloudT*) {});
+// `scan_grid`, when given, must be built over `cloud`: its window queries replace the spatial index
+// wherever they can answer. `index`, when given, is a KD over `cloud` (e.g. the one eps was
+// estimated with) used instead of building another.
+std::vector<PointIndices> runFEC(const CloudT& cloud, const Params& params, const Poll& poll,
+                                 const ScanGrid* scan_grid = nullptr, const KD* index = nullptr) {
+  M2C_TRACE_SCOPE("fec");
   const int min_component_size = 1;           // initial FEC labeling without size filter
   const double tolerance = static_cast<double>(std::max(params.eps, 1e-6f));  // reuse eps as tolerance
   const int max_n = std::max(8, params.minPts_core);  // neighbor cap in radiusSearch
-
-  const std::vector<pcl::PointIndices> fec_clusters = pcg::FEC(cloud_ptr, min_component_size, tolerance, max_n);
-  if (fec_clusters.empty()) {
-    return result;
+  KDOptions kd_options = kdOptions(params);
+  kd_options.radius_hint = static_cast<float>(tolerance);
+  kd_options.poll = poll;  // also reaches the scan grid's fallback KD, built on first use
+  if (scan_grid && scan_grid->valid()) {
+    const ScanGridSearch search(cloud, *scan_grid, kd_options, index);
+    return pcg::FECWith(search, cloud.size(), min_component_size, tolerance, max_n, poll);
   }
+  if (index) {
+    return pcg::FECWith(*index, cloud.size(), min_component_size, tolerance, max_n, poll);
+  }
+  if (cloud.empty()) {
+    return {};
+  }
+  // As pcg::FEC, but with the configured crossovers for the index.
+  const KD kd(cloud, kd_options);
+  return pcg::FECWith(kd, cloud.size(), min_component_size, tolerance, max_n, poll);
+}
 
-  // 2) Compute average cluster size and derive minimum size threshold = floor(n * k)
+// Minimum kept cluster size = floor(n * k), with k the mean cluster size.
+int minKeepSize(const std::vector<ClusterStats>& stats, float n) {
   std::size_t sum_sizes = 0;
-  for (const auto& ci : fec_clusters) sum_sizes += ci.indices.size();
-  const double k = static_cast<double>(sum_sizes) / static_cast<double>(fec_clusters.size());
-  const int min_keep = std::max(1, static_cast<int>(std::floor(params.n * k)));
-
-  // Map point -> clusterId for clusters that pass the threshold
-  std::vector<int> point_to_cluster(cloud.size(), -1);
-  std::vector<int> kept_cluster_ids;
-  kept_cluster_ids.reserve(fec_clusters.size());
-
-  for (std::size_t cid = 0; cid < fec_clusters.size(); ++cid) {
-    const auto& ci = fec_clusters[cid];
-    if (static_cast<int>(ci.indices.size()) < min_keep) {
-      continue;
-    }
-    kept_cluster_ids.push_back(static_cast<int>(cid));
-    for (int idx : ci.indices) {
-      if (idx >= 0 && static_cast<std::size_t>(idx) < point_to_cluster.size()) {
-        point_to_cluster[idx] = static_cast<int>(cid);
-      }
-    }
+  for (const auto& cs : stats) sum_sizes += static_cast<std::size_t>(cs.count);
+  const double k = static_cast<double>(sum_sizes) / static_cast<double>(stats.size());
+  return std::max(1, static_cast<int>(std::floor(n * k)));
+}
+
+// Member lists of an explicit labeling, for voteNearest.
+auto membersOf(const std::vector<PointIndices>& clusters) {
+  return [&clusters](int cid) -> const std::vector<int>& { return clusters[static_cast<std::size_t>(cid)].indices; };
+}
+
+// Returns the id of the cluster (among those with at least `min_keep` points) that owns most
+// of the `m` points nearest to C, ties broken by smaller total distance; -1 when none qualifies.
+// Cluster summaries bound which clusters can reach the top-m at all, so only their points are scanned;
+// `stats[cid].nearest` may be a lower bound. `members(cid)` returns the member indices of a cluster.
+template <typename Members>
+int voteNearest(const CloudT& cloud,
+                const Members& members,
+                const std::vector<ClusterStats>& stats,
+                int min_keep,
+                const Eigen::Vector3f& C,
+                int m,
+                const Poll& poll) {
+  M2C_TRACE_SCOPE("vote");
+  std::vector<int> kept;
+  for (std::size_t cid = 0; cid < stats.size(); ++cid) {
+    if (stats[cid].count >= min_keep) kept.push_back(static_cast<int>(cid));
+  }
+  if (kept.empty()) {
+    return -1;
   }
 
-  if (kept_cluster_ids.empty()) {
-    return result;
+  // Walking kept clusters by nearest distance, the first ones holding >= m points guarantee the
+  // m-th nearest point lies within `reach`; clusters whose nearest point is farther cannot vote.
+  std::sort(kept.begin(), kept.end(), [&stats](int a, int b) { return stats[a].nearest < stats[b].nearest; });
+  const std::size_t want = static_cast<std::size_t>(std::max(1, m));
+  float reach = 0.0f;
+  std::size_t covered = 0;
+  for (int cid : kept) {
+    reach = std::max(reach, stats[cid].farthestBound(C));
+    covered += static_cast<std::size_t>(stats[cid].count);
+    if (covered >= want) break;
   }
 
-  // 3) Find the m points (across kept clusters) nearest to C
+  // Find the m points (across kept clusters) nearest to C
   struct NearRec { float dist; int idx; int cid; };
   std::vector<NearRec> pool;
-  pool.reserve(cloud.size());
 
-  for (std::size_t i = 0; i < cloud.size(); ++i) {
-    const int cid = point_to_cluster[i];
-    if (cid < 0) continue;  // skip filtered-out clusters
-    const PointT& p = cloud[i];
-    const float dx = p.x - pose.C.x();
-    const float dy = p.y - pose.C.y();
-    const float dz = p.z - pose.C.z();
-    const float dist = std::sqrt(dx * dx + dy * dy + dz * dz);
-    pool.push_back({dist, static_cast<int>(i), cid});
+  for (int cid : kept) {
+    if (stats[cid].nearest > reach) break;  // kept is sorted by nearest distance
+    if (poll) poll();
+    for (int idx : members(cid)) {
+      const PointT& p = cloud[static_cast<std::size_t>(idx)];
+      const float dx = p.x - C.x();
+      const float dy = p.y - C.y();
+      const float dz = p.z - C.z();
+      const float dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+      pool.push_back({dist, idx, cid});
+    }
   }
 
   if (pool.empty()) {
-    return result;
+    return -1;
   }
 
-  const std::size_t take = std::min<std::size_t>(static_cast<std::size_t>(std::max(1, params.m)), pool.size());
+  const std::size_t take = std::min<std::size_t>(want, pool.size());
   std::nth_element(pool.begin(), pool.begin() + take, pool.end(), [](const NearRec& a, const NearRec& b){ return a.dist < b.dist; });
   pool.resize(take);
 
-  // 4) Vote: cluster with the most occurrences among the top-m nearest points
-  std::unordered_map<int, int> counts;          // cid -> count
-  std::unordered_map<int, double> dist_sums;    // cid -> sum of distances (for tie-breaker)
+  // Vote: cluster with the most occurrences among the top-m nearest points
+  std::unordered_map<int, std::pair<int, double>> tally;  // cid -> (count, sum of distances)
+  for (const auto& rec : pool) {
+    auto& t = tally[rec.cid];
+    t.first += 1;
+    t.second += rec.dist;
+  }
+
   int best_cid = -1;
   int best_count = -1;
   double best_sum = std::numeric_limits<double>::infinity();
-
-  for (const auto& rec : pool) {
-    int& c = counts[rec.cid];
-    c += 1;
-    dist_sums[rec.cid] += rec.dist;
-    if (c > best_count || (c == best_count && dist_sums[rec.cid] < best_sum)) {
+  for (const auto& entry : tally) {
+    const int c = entry.second.first;
+    const double sum = entry.second.second;
+    // Exact ties go to the lowest cluster id, so the winner does not depend on hash order
+    if (c > best_count || (c == best_count && sum < best_sum) ||
+        (c == best_count && sum == best_sum && entry.first < best_cid)) {
       best_count = c;
-      best_sum = dist_sums[rec.cid];
-      best_cid = rec.cid;
+      best_sum = sum;
+      best_cid = entry.first;
     }
   }
 
-  if (best_cid < 0) {
+  return best_cid;
+}
+
+// Exact FEC restricted to the points of one (approximate) component. Replaces `cluster` and its
+// `summary` with the winning sub-cluster (original cloud indices), or leaves them unchanged when
+// none qualifies.
+void refineComponent(const CloudT& cloud, const Pose& pose, const Params& params, const Poll& poll,
+                     Cluster& cluster, ClusterStats& summary) {
+  const std::vector<int>& component = cluster.indices;
+  CloudT sub;
+  sub.reserve(component.size());
+  for (int idx : component) {
+    sub.push_back(cloud[idx]);
+  }
+  sub.width = static_cast<std::uint32_t>(sub.size());
+  sub.height = 1;
+  sub.is_dense = false;
+
+  const std::vector<PointIndices> parts = runFEC(sub, params, poll);
+  if (parts.empty()) {
+    return;
+  }
+
+  std::vector<int> sub_labels;
+  const std::vector<ClusterStats> part_stats = labelClusters(sub, parts, pose.C, sub_labels);
+  const int best = voteNearest(sub, membersOf(parts), part_stats, minKeepSize(part_stats, params.n), pose.C, params.m, poll);
+  if (best < 0) {
+    return;
+  }
+
+  std::vector<int> refined;
+  refined.reserve(parts[static_cast<std::size_t>(best)].indices.size());
+  for (int local : parts[static_cast<std::size_t>(best)].indices) {
+    refined.push_back(component[static_cast<std::size_t>(local)]);
+  }
+  cluster.indices = std::move(refined);
+  summary = part_stats[static_cast<std::size_t>(best)];
+  cluster.diameter = summary.diameter();
+}
+
+// Final validation of a voted cluster on its summary (minPts_total, maxDiameter). A rejected winner
+// leaves the result not found, with `rejected` set and cluster_id still naming it.
+void screenWinner(const ClusterStats& winner, const Params& params, Result& result) {
+  if (!result.found || Validator{params.minPts_total, params.maxDiameter}.pass(winner)) {
+    return;
+  }
+  result.found = false;
+  result.rejected = true;
+  result.cluster = Cluster();
+}
+
+// Summarize precomputed clusters, apply the size filter and vote around C. The winner is not yet
+// validated (see screenWinner), so a component can still be refined first.
+Result voteClusters(const CloudT& cloud, const std::vector<PointIndices>& clusters, const Pose& pose,
+                    const Params& params, const Poll& poll) {
+  Result result;
+  if (clusters.empty()) {
     return result;
   }
 
-  // Compose result from the selected cluster
-  const auto& chosen = fec_clusters[static_cast<std::size_t>(best_cid)];
-  Cluster out;
-  out.indices = chosen.indices;
-
-  // estimate diameter via AABB
-  float min_x = std::numeric_limits<float>::max();
-  float min_y = std::numeric_limits<float>::max();
-  float min_z = std::numeric_limits<float>::max();
-  float max_x = std::numeric_limits<float>::lowest();
-  float max_y = std::numeric_limits<float>::lowest();
-  float max_z = std::numeric_limits<float>::lowest();
-  for (int idx : out.indices) {
-    if (idx < 0 || static_cast<std::size_t>(idx) >= cloud.size()) continue;
-    const PointT& p = cloud[idx];
-    min_x = std::min(min_x, p.x); max_x = std::max(max_x, p.x);
-    min_y = std::min(min_y, p.y); max_y = std::max(max_y, p.y);
-    min_z = std::min(min_z, p.z); max_z = std::max(max_z, p.z);
-  }
-  const float dx = max_x - min_x;
-  const float dy = max_y - min_y;
-  const float dz = max_z - min_z;
-  out.diameter = std::sqrt(dx * dx + dy * dy + dz * dz);
+  // Per-cluster summaries (size, AABB, centroid, nearest distance to C) in the labeling sweep
+  result.stats = labelClusters(cloud, clusters, pose.C, result.labels);
+  if (poll) poll();
 
+  // Discard clusters smaller than floor(n * mean_size), then vote among the m nearest-to-C points
+  result.min_keep = minKeepSize(result.stats, params.n);
+  const int best_cid = voteNearest(cloud, membersOf(clusters), result.stats, result.min_keep, pose.C, params.m, poll);
+  if (best_cid < 0) {
+    return result;
+  }
+
+  // Compose result from the selected cluster; the AABB diameter comes from its summary
   result.found = true;
   result.trials = 1;
-  result.cluster = std::move(out);
+  result.cluster_id = best_cid;
+  result.cluster.indices = clusters[static_cast<std::size_t>(best_cid)].indices;
+  result.cluster.diameter = result.stats[static_cast<std::size_t>(best_cid)].diameter();
+  return result;
+}
+
+// Label with the given engine, then summarize and vote.
+Result labelAndVote(const CloudT& cloud, const Pose& pose, const Params& params, ClusterAlgo algo,
+                    float cell, const Poll& poll, const ScanGrid* scan_grid = nullptr, const KD* index = nullptr) {
+  // Label the full (possibly downsampled) cloud: FEC, or voxel connectivity for previews
+  const std::vector<PointIndices> clusters = algo == ClusterAlgo::VoxelCC
+                                                 ? voxelConnectedComponents(cloud, cell, poll)
+                                                 : runFEC(cloud, params, poll, scan_grid, index);
+
+  Result result = voteClusters(cloud, clusters, pose, params, poll);
+  if (!result.found) {
+    return result;
+  }
+  ClusterStats winner = result.stats[static_cast<std::size_t>(result.cluster_id)];
+  if (algo == ClusterAlgo::VoxelCC && params.refine) {
+    refineComponent(cloud, pose, params, poll, result.cluster, winner);
+  }
+  screenWinner(winner, params, result);
+  return result;
+}
+
+// Coarse tier: FEC with the unchanged eps over the cloud re-voxelized at `leaf`, each component
+// mapped back to the input points of its voxels, then the usual summary, size filter and vote.
+Result coarseFEC(const CloudT& cloud, const Pose& pose, const Params& params, float leaf, const Poll& poll) {
+  M2C_TRACE_SCOPE("coarseFEC");
+  std::vector<int> voxel_of;
+  const CloudT::Ptr coarse = voxelDownsample(cloud, leaf, nullptr, &voxel_of, poll);
+  const std::vector<PointIndices> parts = runFEC(*coarse, params, poll);
+
+  std::vector<int> part_of(coarse->size(), -1);
+  for (std::size_t c = 0; c < parts.size(); ++c) {
+    for (int v : parts[c].indices) part_of[static_cast<std::size_t>(v)] = static_cast<int>(c);
+  }
+  std::vector<PointIndices> clusters(parts.size());
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    const int v = voxel_of[i];
+    if (v < 0) continue;  // non-finite point
+    const int c = part_of[static_cast<std::size_t>(v)];
+    clusters[static_cast<std::size_t>(c)].indices.push_back(static_cast<int>(i));
+  }
+  if (poll) poll();
+
+  Result result = voteClusters(cloud, clusters, pose, params, poll);
+  if (result.found) {
+    screenWinner(result.stats[static_cast<std::size_t>(result.cluster_id)], params, result);
+  }
+  return result;
+}
+
+// Eps for the fallback tiers when the primary tier was cancelled before its estimate finished: the
+// same k-distance estimate, over only the kLocalEpsPoints points nearest to C so its cost is bounded.
+float localEps(const CloudT& cloud, const Pose& pose, const Params& params, const Poll& poll) {
+  M2C_TRACE_SCOPE("localEps");
+  const CloudT* source = &cloud;
+  CloudT local;
+  if (cloud.size() > kLocalEpsPoints) {
+    std::vector<Candidate> by_distance(cloud.size());
+    for (std::size_t i = 0; i < cloud.size(); ++i) {
+      if (poll && (i & 65535u) == 0) poll();
+      const PointT& p = cloud[i];
+      const float dx = p.x - pose.C.x();
+      const float dy = p.y - pose.C.y();
+      const float dz = p.z - pose.C.z();
+      const float d2 = dx * dx + dy * dy + dz * dz;
+      by_distance[i] = {static_cast<int>(i), std::isfinite(d2) ? d2 : std::numeric_limits<float>::infinity()};
+    }
+    const auto cut = by_distance.begin() + static_cast<std::ptrdiff_t>(kLocalEpsPoints);
+    std::nth_element(by_distance.begin(), cut, by_distance.end(),
+                     [](const Candidate& a, const Candidate& b) { return a.distance < b.distance; });
+    local.reserve(kLocalEpsPoints);
+    for (auto it = by_distance.begin(); it != cut; ++it) {
+      local.push_back(cloud[static_cast<std::size_t>(it->index)]);
+    }
+    local.width = static_cast<std::uint32_t>(local.size());
+    local.height = 1;
+    local.is_dense = false;
+    source = &local;
+  }
+  KDOptions kd_options = kdOptions(params);
+  kd_options.poll = poll;
+  const KD kd(*source, kd_options);
+  return estimateEps(*source, kd, params.minPts_core, kEpsSamples, poll).eps;
+}
+
+// Last-resort tier: seeded DBSCAN from the `max_trials` points nearest to C. Only a local crop is
+// indexed: any cluster that contains one of those seeds and passes the diameter check lies within
+// (distance of the farthest seed + maxDiameter) of C.
+Result seededLocal(const CloudT& cloud, const Pose& pose, const Params& params, const Deadline& deadline) {
+  M2C_TRACE_SCOPE("seeded");
+  Result result;
+
+  std::vector<Candidate> by_distance;
+  by_distance.reserve(cloud.size());
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    if ((i & 65535u) == 0) deadline.check();
+    const PointT& p = cloud[i];
+    const float dx = p.x - pose.C.x();
+    const float dy = p.y - pose.C.y();
+    const float dz = p.z - pose.C.z();
+    by_distance.push_back({static_cast<int>(i), std::sqrt(dx * dx + dy * dy + dz * dz)});
+  }
+
+  const std::size_t seeds = std::min<std::size_t>(static_cast<std::size_t>(std::max(1, params.max_trials)), by_distance.size());
+  const auto closer = [](const Candidate& a, const Candidate& b) { return a.distance < b.distance; };
+  std::partial_sort(by_distance.begin(), by_distance.begin() + seeds, by_distance.end(), closer);
+
+  const float reach = params.maxDiameter > 0.0f ? by_distance[seeds - 1].distance + params.maxDiameter
+                                                : std::numeric_limits<float>::infinity();
+  CloudT local;
+  std::vector<int> local_to_cloud;
+  for (const Candidate& c : by_distance) {
+    if (c.distance <= reach) {
+      local.push_back(cloud[c.index]);
+      local_to_cloud.push_back(c.index);
+    }
+  }
+  local.width = static_cast<std::uint32_t>(local.size());
+  local.height = 1;
+  local.is_dense = false;
+  deadline.check();
+
+  // by_distance is sorted for its first `seeds` entries, so local indices [0, seeds) are the seeds.
+  KDOptions kd_options = kdOptions(params);
+  kd_options.radius_hint = params.eps;
+  kd_options.poll = [&deadline]() { deadline.check(); };
+  const KD kd(local, kd_options);
+  const Validator validator{params.minPts_total, params.maxDiameter};
+  std::vector<char> visited(local.size(), 0);
+  for (std::size_t seed = 0; seed < seeds; ++seed) {
+    deadline.check();
+    if (visited[seed]) {
+      continue;
+    }
+    ++result.trials;
+    Cluster grown = growFromSeed_DBSCAN(static_cast<int>(seed), local, kd, std::max(params.eps, 1e-6f),
+                                        params.minPts_core, params.maxPts, params.maxDiameter,
+                                        [&deadline]() { deadline.check(); });
+    for (int idx : grown.indices) visited[idx] = 1;
+    if (!validator.pass(grown)) {
+      continue;
+    }
+    for (int& idx : grown.indices) idx = local_to_cloud[static_cast<std::size_t>(idx)];
+    result.found = true;
+    result.cluster = std::move(grown);
+    return result;
+  }
+  return result;
+}
+
+}  // namespace
+
+const char* tierName(Tier tier) {
+  switch (tier) {
+    case Tier::Primary: return "primary";
+    case Tier::Coarse: return "coarse";
+    case Tier::Seeded: return "seeded";
+  }
+  return "unknown";
+}
+
+Result selectFromClusters(const CloudT& cloud,
+                          const std::vector<PointIndices>& clusters,
+                          const Pose& pose,
+                          const Params& params) {
+  M2C_TRACE_SCOPE("selectFromClusters");
+  const auto start = std::chrono::steady_clock::now();
+  Result result = voteClusters(cloud, clusters, pose, params, Poll());
+  if (result.found) {
+    screenWinner(result.stats[static_cast<std::size_t>(result.cluster_id)], params, result);
+  }
+  result.eps = params.eps;
+  TierReport report;
+  report.completed = true;
+  report.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  result.tiers.push_back(report);
+  return result;
+}
+
+Result selectIncremental(const IncrementalClusterer& state, const Pose& pose, const Params& params) {
+  M2C_TRACE_SCOPE("selectIncremental");
+  const auto start = std::chrono::steady_clock::now();
+  Result result;
+  result.eps = state.eps();
+  const std::vector<IncrementalClusterer::Component>& components = state.components();
+  if (!components.empty()) {
+    result.stats.resize(components.size());
+    for (std::size_t k = 0; k < components.size(); ++k) {
+      const IncrementalClusterer::Component& component = components[k];
+      ClusterStats& cs = result.stats[k];
+      cs.count = component.count;
+      cs.min = component.min;
+      cs.max = component.max;
+      cs.centroid = (component.sum / static_cast<double>(component.count)).cast<float>();
+      cs.nearest = (cs.min - pose.C).cwiseMax(pose.C - cs.max).cwiseMax(0.0f).norm();  // to the box
+    }
+    result.min_keep = minKeepSize(result.stats, params.n);
+    std::vector<int> scratch;
+    const auto members = [&state, &scratch](int cid) -> const std::vector<int>& {
+      state.members(static_cast<std::size_t>(cid), scratch);
+      return scratch;
+    };
+    const int best_cid = voteNearest(state.cloud(), members, result.stats, result.min_keep, pose.C, params.m, Poll());
+    if (best_cid >= 0) {
+      result.found = true;
+      result.trials = 1;
+      result.cluster_id = best_cid;
+      state.members(static_cast<std::size_t>(best_cid), result.cluster.indices);
+      std::sort(result.cluster.indices.begin(), result.cluster.indices.end());
+      result.cluster.diameter = result.stats[static_cast<std::size_t>(best_cid)].diameter();
+      screenWinner(result.stats[static_cast<std::size_t>(best_cid)], params, result);
+    }
+  }
+  TierReport report;
+  report.completed = true;
+  report.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  result.tiers.push_back(report);
+  return result;
+}
+
+Result selectCluster(const CloudT& cloud, const Pose& pose, const Params& requested, const ScanGrid* scan_grid) {
+  M2C_TRACE_SCOPE("selectCluster");
+  Result result;
+  result.eps = requested.eps;
+
+  if (cloud.empty()) {
+    return result;
+  }
+
+  // Without a deadline the primary tier can never be cancelled, and the seeded tier runs only when
+  // the primary winner fails validation.
+  const Deadline budget(requested.deadline);
+  Params params = requested;
+  bool eps_known = !params.eps_auto;
+  std::optional<KD> index;  // Built for the eps estimate; the primary tier's FEC reuses it.
+  struct Step { Tier tier; double until; };  // `until`: cumulative share of the budget
+  const Step plan[] = {{Tier::Primary, 0.6}, {Tier::Coarse, 0.85}, {Tier::Seeded, 1.0}};
+  bool rejected = false;  // A completed tier voted a cluster that failed validation.
+
+  for (const Step& step : plan) {
+    // The coarse tier approximates the primary labeling, so after a rejected winner only seeded
+    // growth can still find a different cluster.
+    if (rejected && step.tier != Tier::Seeded) {
+      continue;
+    }
+    // An index build polls only between large subtrees, so the primary tier can overrun its slice:
+    // the coarse tier still gets its own share from wherever it starts, and the seeded tier (a
+    // local crop) is never cancelled, so a deadline ends in an answer whenever one qualifies.
+    const Deadline slice = step.tier == Tier::Seeded ? Deadline()
+                         : step.tier == Tier::Coarse ? budget.slice(step.until).atLeast(kCoarseShare * requested.deadline)
+                                                     : budget.slice(step.until);
+    const Poll poll = slice.unlimited() ? Poll() : Poll([&slice]() { slice.check(); });
+    M2C_TRACE_SCOPE(tierName(step.tier));
+
+    TierReport report;
+    report.tier = step.tier;
+    report.budget_ms = budget.unlimited() ? 0.0 : slice.unlimited() ? budget.remainingMs() : slice.remainingMs();
+    const auto start = std::chrono::steady_clock::now();
+
+    Result attempt;
+    try {
+      if (!eps_known) {
+        // The primary tier estimates eps over the whole cloud within its slice; a fallback tier
+        // only gets here when that was cancelled, and estimates it near C instead.
+        if (step.tier == Tier::Primary) {
+          KDOptions kd_options = kdOptions(params);
+          kd_options.poll = poll;
+          index.emplace(cloud, kd_options);
+          params.eps = estimateEps(cloud, *index, params.minPts_core, kEpsSamples, poll).eps;
+        } else {
+          params.eps = localEps(cloud, pose, params, poll);
+        }
+        eps_known = true;
+      }
+      const float eps = std::max(params.eps, 1e-6f);
+      switch (step.tier) {
+        case Tier::Primary:
+          attempt = labelAndVote(cloud, pose, params, params.algo, eps, poll, scan_grid, index ? &*index : nullptr);
+          break;
+        case Tier::Coarse:
+          // Twice the working voxel, and at least eps / 2 so an unfiltered cloud still shrinks.
+          attempt = coarseFEC(cloud, pose, params, std::max(2.0f * params.voxel, 0.5f * eps), poll);
+          break;
+        case Tier::Seeded:
+          attempt = seededLocal(cloud, pose, params, slice);
+          break;
+      }
+      report.completed = true;
+    } catch (const DeadlineExceeded&) {
+      report.completed = false;
+    }
+
+    report.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    report.rejected = attempt.rejected;
+    result.tiers.push_back(report);
+    if (report.completed && attempt.rejected && step.tier != Tier::Seeded) {
+      rejected = true;
+    } else if (report.completed) {
+      attempt.tier = step.tier;
+      attempt.tiers = std::move(result.tiers);
+      attempt.eps = params.eps;
+      return attempt;
+    }
+  }
+
   return result;
 }
 
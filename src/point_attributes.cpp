@@ -0,0 +1,63 @@
+#include "m2c/point_attributes.h"
+
+#include <cstddef>
+
+namespace m2c {
+namespace {
+
+template <typename T>
+void appendColumn(std::vector<T>& to, const std::vector<T>& from) {
+  to.insert(to.end(), from.begin(), from.end());
+}
+
+template <typename T>
+std::vector<T> selectColumn(const std::vector<T>& column, const std::vector<int>& indices) {
+  std::vector<T> out;
+  if (column.empty()) {
+    return out;
+  }
+  out.reserve(indices.size());
+  for (int idx : indices) {
+    out.push_back(column[static_cast<std::size_t>(idx)]);
+  }
+  return out;
+}
+
+}  // namespace
+
+void PointAttributes::clear() {
+  intensity.clear();
+  classification.clear();
+  red.clear();
+  green.clear();
+  blue.clear();
+  scan_angle.clear();
+  gps_time.clear();
+}
+
+void PointAttributes::append(const PointAttributes& other) {
+  appendColumn(intensity, other.intensity);
+  appendColumn(classification, other.classification);
+  appendColumn(red, other.red);
+  appendColumn(green, other.green);
+  appendColumn(blue, other.blue);
+  appendColumn(scan_angle, other.scan_angle);
+  appendColumn(gps_time, other.gps_time);
+  color_bits = other.color_bits;
+}
+
+PointAttributes PointAttributes::select(const std::vector<int>& indices) const {
+  PointAttributes out;
+  out.intensity = selectColumn(intensity, indices);
+  out.classification = selectColumn(classification, indices);
+  out.red = selectColumn(red, indices);
+  out.green = selectColumn(green, indices);
+  out.blue = selectColumn(blue, indices);
+  out.scan_angle = selectColumn(scan_angle, indices);
+  out.gps_time = selectColumn(gps_time, indices);
+  out.color_bits = color_bits;
+  out.scan_order = scan_order;
+  return out;
+}
+
+}  // namespace m2c
@@ -0,0 +1,59 @@
+#include "m2c/quantile_sketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace m2c {
+
+QuantileSketch::QuantileSketch(double relative_accuracy) {
+  if (!(relative_accuracy > 0.0 && relative_accuracy < 1.0)) {
+    throw std::invalid_argument("QuantileSketch accuracy must lie in (0, 1)");
+  }
+  gamma_ = (1.0 + relative_accuracy) / (1.0 - relative_accuracy);
+  log_gamma_ = std::log(gamma_);
+}
+
+void QuantileSketch::add(double value) {
+  if (!(value >= 0.0) || !std::isfinite(value)) {
+    return;
+  }
+  ++count_;
+  if (value == 0.0) {
+    ++zeros_;
+    return;
+  }
+  ++buckets_[static_cast<int>(std::ceil(std::log(value) / log_gamma_))];
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+  if (other.gamma_ != gamma_) {
+    throw std::invalid_argument("Cannot merge quantile sketches with different accuracy");
+  }
+  zeros_ += other.zeros_;
+  count_ += other.count_;
+  for (const auto& bucket : other.buckets_) {
+    buckets_[bucket.first] += bucket.second;
+  }
+}
+
+double QuantileSketch::quantile(double q) const {
+  if (count_ == 0) {
+    return 0.0;
+  }
+  const double rank = std::clamp(q, 0.0, 1.0) * static_cast<double>(count_ - 1);
+  std::uint64_t seen = zeros_;
+  if (static_cast<double>(seen) > rank) {
+    return 0.0;
+  }
+  for (const auto& bucket : buckets_) {
+    seen += bucket.second;
+    if (static_cast<double>(seen) > rank) {
+      // Midpoint (in relative terms) of the bucket's range.
+      return 2.0 * std::pow(gamma_, bucket.first) / (gamma_ + 1.0);
+    }
+  }
+  return 2.0 * std::pow(gamma_, buckets_.rbegin()->first) / (gamma_ + 1.0);
+}
+
+}  // namespace m2c
@@ -0,0 +1,217 @@
+#include "m2c/scan_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+#include "m2c/trace.h"
+
+namespace m2c {
+namespace {
+
+bool isFinite(const PointT& p) {
+  return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+}
+
+template <typename T>
+T median(std::vector<T>& values) {
+  const auto mid = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+  std::nth_element(values.begin(), mid, values.end());
+  return *mid;
+}
+
+}  // namespace
+
+ScanGrid::ScanGrid(const CloudT& cloud, const PointAttributes& scan, const ScanGridOptions& options)
+    : max_window_(std::max(1, options.max_window)) {
+  M2C_TRACE_SCOPE("scanGrid");
+  const std::size_t n = cloud.size();
+  if (n < 2 || scan.scan_angle.size() != n || scan.gps_time.size() != n) {
+    return;
+  }
+  const std::vector<float>& angle = scan.scan_angle;
+  const std::vector<double>& time = scan.gps_time;
+
+  // Acquisition order: the file order unless it was rewritten (indexed or merged files).
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  if (!std::is_sorted(time.begin(), time.end())) {
+    std::stable_sort(order.begin(), order.end(), [&time](int a, int b) { return time[a] < time[b]; });
+  }
+
+  // Angle step and pulse interval: medians over consecutive points, ignoring repeats.
+  std::vector<float> steps;
+  std::vector<double> intervals;
+  steps.reserve(n);
+  intervals.reserve(n);
+  for (std::size_t k = 1; k < n; ++k) {
+    const float da = std::fabs(angle[order[k]] - angle[order[k - 1]]);
+    const double dt = time[order[k]] - time[order[k - 1]];
+    if (da > 0.0f) steps.push_back(da);
+    if (dt > 0.0) intervals.push_back(dt);
+  }
+  if (steps.empty()) {
+    return;
+  }
+  const float step = median(steps);
+  const double interval = intervals.empty() ? 0.0 : median(intervals);
+  if (!(step > 0.0f) || !std::isfinite(step)) {
+    return;
+  }
+
+  // Scanlines: a new one at a turn against the current sweep direction, or at a time gap longer than
+  // the angle advanced accounts for (missing returns, e.g. sky, skip angle and time alike).
+  row_.assign(n, -1);
+  col_.assign(n, -1);
+  const float min_angle = *std::min_element(angle.begin(), angle.end());
+  const float max_angle = *std::max_element(angle.begin(), angle.end());
+  const double span = std::round((static_cast<double>(max_angle) - min_angle) / step) + 1.0;
+  int line = 0;
+  float direction = 0.0f;
+  for (std::size_t k = 0; k < n; ++k) {
+    const int id = order[k];
+    if (k > 0) {
+      const float da = angle[id] - angle[order[k - 1]];
+      const double dt = time[id] - time[order[k - 1]];
+      const double pulses = std::max(1.0, std::fabs(static_cast<double>(da)) / step);
+      if (direction * da < -0.5f * step || (interval > 0.0 && dt > options.line_gap * pulses * interval)) {
+        ++line;
+        direction = 0.0f;  // set by the line's own first step, not the jump into it
+      } else if (direction == 0.0f && std::fabs(da) >= 0.5f * step) {
+        direction = da > 0.0f ? 1.0f : -1.0f;
+      }
+    }
+    row_[id] = line;
+    col_[id] = static_cast<int>(std::lround((angle[id] - min_angle) / step));
+  }
+  const double cells = static_cast<double>(line + 1) * span;
+  if (cells > static_cast<double>(options.max_cells_per_point) * static_cast<double>(n)) {
+    row_.clear();
+    col_.clear();
+    return;
+  }
+  rows_ = line + 1;
+  cols_ = static_cast<int>(span);
+
+  // Counting sort of the finite points into their cells.
+  const std::size_t cell_count = static_cast<std::size_t>(rows_) * static_cast<std::size_t>(cols_);
+  const auto cellOf = [this](std::size_t i) {
+    return static_cast<std::size_t>(row_[i]) * static_cast<std::size_t>(cols_) + static_cast<std::size_t>(col_[i]);
+  };
+  start_.assign(cell_count + 1, 0);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!isFinite(cloud[i])) {
+      row_[i] = -1;
+      continue;
+    }
+    ++start_[cellOf(i) + 1];
+    ++placed_;
+  }
+  const std::size_t occupied =
+      static_cast<std::size_t>(std::count_if(start_.begin() + 1, start_.end(), [](int count) { return count > 0; }));
+  if (static_cast<float>(occupied) < options.min_occupancy * static_cast<float>(placed_)) {
+    *this = ScanGrid();
+    return;
+  }
+  std::partial_sum(start_.begin(), start_.end(), start_.begin());
+  ids_.resize(placed_);
+  std::vector<int> next(start_.begin(), start_.end() - 1);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (row_[i] >= 0) ids_[static_cast<std::size_t>(next[cellOf(i)]++)] = static_cast<int>(i);
+  }
+}
+
+bool ScanGrid::radius(const CloudT& cloud, int idx, float r, std::vector<int>& out, int max_nn) const {
+  out.clear();
+  if (!valid() || idx < 0 || static_cast<std::size_t>(idx) >= row_.size() || row_[static_cast<std::size_t>(idx)] < 0 ||
+      !(r > 0.0f)) {
+    return false;
+  }
+  const int row = row_[static_cast<std::size_t>(idx)];
+  const int col = col_[static_cast<std::size_t>(idx)];
+  const PointT& q = cloud[static_cast<std::size_t>(idx)];
+  const float r2 = r * r;
+  thread_local std::vector<std::pair<float, int>> hits;
+  hits.clear();
+
+  // A ring "hits" when one of its points lies within `bound`: r, or once max_nn hits are found, the
+  // max_nn-th nearest so far.
+  thread_local std::vector<float> nearest;
+  const std::size_t cap = max_nn > 0 ? static_cast<std::size_t>(max_nn) : 0;
+  float bound = r2;
+  bool ring_hit = false;
+  bool ring_occupied = false;
+  const auto visit = [&](int rr, int cc) {
+    const auto points = cell(rr, cc);
+    for (const int* id = points.first; id != points.second; ++id) {
+      ring_occupied = true;
+      const PointT& p = cloud[static_cast<std::size_t>(*id)];
+      const float dx = p.x - q.x;
+      const float dy = p.y - q.y;
+      const float dz = p.z - q.z;
+      const float d2 = dx * dx + dy * dy + dz * dz;
+      if (d2 <= r2) {
+        hits.emplace_back(d2, *id);
+        ring_hit = ring_hit || d2 <= bound;
+      }
+    }
+  };
+  visit(row, col);  // the point itself and any other return of its pulse
+  for (int w = 1;; ++w) {
+    if (w > max_window_) {
+      return false;
+    }
+    if (cap > 0 && hits.size() >= cap) {
+      nearest.clear();
+      for (const auto& hit : hits) nearest.push_back(hit.first);
+      std::nth_element(nearest.begin(), nearest.begin() + static_cast<std::ptrdiff_t>(cap - 1), nearest.end());
+      bound = nearest[cap - 1];
+    }
+    ring_hit = false;
+    ring_occupied = false;
+    for (int cc = col - w; cc <= col + w; ++cc) {
+      visit(row - w, cc);
+      visit(row + w, cc);
+    }
+    for (int rr = row - w + 1; rr <= row + w - 1; ++rr) {
+      visit(rr, col - w);
+      visit(rr, col + w);
+    }
+    if (ring_occupied && !ring_hit) {
+      break;  // The surface has left the radius (or the nearest max_nn) on every side.
+    }
+  }
+
+  std::size_t keep = hits.size();
+  if (max_nn > 0 && static_cast<std::size_t>(max_nn) < keep) {
+    keep = static_cast<std::size_t>(max_nn);
+    std::partial_sort(hits.begin(), hits.begin() + static_cast<std::ptrdiff_t>(keep), hits.end());
+  } else {
+    std::sort(hits.begin(), hits.end());
+  }
+  out.reserve(keep);
+  for (std::size_t i = 0; i < keep; ++i) {
+    out.push_back(hits[i].second);
+  }
+  return true;
+}
+
+ScanGridSearch::ScanGridSearch(const CloudT& cloud, const ScanGrid& grid, const KDOptions& options, const KD* index)
+    : cloud_(cloud), grid_(grid), options_(options), index_(index) {}
+
+void ScanGridSearch::radius(int idx, float r, std::vector<int>& out, int max_nn) const {
+  if (grid_.radius(cloud_, idx, r, out, max_nn)) {
+    grid_queries_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  fallback_queries_.fetch_add(1, std::memory_order_relaxed);
+  if (index_) {
+    index_->radius(idx, r, out, max_nn);
+    return;
+  }
+  std::call_once(fallback_once_, [this]() { fallback_ = std::make_unique<KD>(cloud_, options_); });
+  fallback_->radius(idx, r, out, max_nn);
+}
+
+}  // namespace m2c
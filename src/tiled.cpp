@@ -0,0 +1,608 @@
+#include "m2c/tiled.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "m2c/cluster_stats.h"
+#include "m2c/frustum.h"
+#include "m2c/incremental.h"
+#include "m2c/io_las.h"
+#include "m2c/trace.h"
+#include "m2c/validator.h"
+#include "m2c/voxel_grid.h"
+#include "m2c/voxel_key.h"
+
+namespace m2c {
+namespace {
+
+constexpr std::size_t kSpillBufferBytes = 64u << 10;
+constexpr std::size_t kMaxOpenFiles = 64;  // Tile files kept open during the spill pass.
+constexpr std::size_t kBytesPerTilePoint = 96;  // points, ids, union-find, grid and labels while labeling
+
+#pragma pack(push, 1)
+struct RawRecord {
+  float x, y, z;
+  std::uint64_t id;
+};
+
+struct LabeledRecord {
+  float x, y, z;
+  std::uint64_t id;
+  std::int32_t comp;  // tile-local component
+};
+#pragma pack(pop)
+
+struct Tile {
+  std::int32_t tx = 0;
+  std::int32_t ty = 0;
+  std::string raw_path;
+  std::string labeled_path;
+  std::uint64_t count = 0;   // raw records spilled
+};
+
+struct SeamPoint {
+  float x, y, z;
+  std::uint32_t tile;
+  std::int32_t comp;
+};
+
+struct TileSummary {
+  std::vector<ClusterStats> stats;  // per tile-local component
+  std::vector<SeamPoint> seam;
+};
+
+std::uint64_t tileKey(std::int32_t tx, std::int32_t ty) {
+  return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(tx)) << 32) | static_cast<std::uint32_t>(ty);
+}
+
+void writeFile(const std::string& path, const char* data, std::size_t bytes) {
+  std::FILE* f = std::fopen(path.c_str(), "wb");
+  if (!f) {
+    throw std::runtime_error("Failed to open tile file: " + path);
+  }
+  const std::size_t written = std::fwrite(data, 1, bytes, f);
+  const int rc = std::fclose(f);
+  if (written != bytes || rc != 0) {
+    throw std::runtime_error("Failed to write tile file: " + path);
+  }
+}
+
+// Buffers raw records per tile and appends them to the tile files. Buffers are kSpillBufferBytes
+// blocks drawn from a pool capped by the memory budget: a tile holds at most one and writes it out
+// when it fills; when the pool runs dry, the fullest quarter of the blocks in use is written out and
+// returned. At most kMaxOpenFiles tile files stay open, the least recently written closed first.
+class SpillWriter {
+ public:
+  SpillWriter(const std::vector<Tile>& tiles, std::size_t budget_bytes)
+      : tiles_(tiles), max_blocks_(std::max<std::size_t>(1, budget_bytes / kSpillBufferBytes)) {}
+
+  ~SpillWriter() {
+    for (std::size_t t : open_) std::fclose(slots_[t].file);
+  }
+
+  void add(std::size_t tile, const RawRecord& record) {
+    if (slots_.size() <= tile) slots_.resize(tile + 1);
+    if (!slots_[tile].block) slots_[tile].block = acquire();
+    Slot& slot = slots_[tile];
+    std::memcpy(slot.block.get() + slot.used, &record, sizeof(record));
+    slot.used += sizeof(record);
+    if (slot.used + sizeof(record) > kSpillBufferBytes) write(tile);
+  }
+
+  // Writes out every pending record and closes the files; the pool is released.
+  void finish() {
+    for (std::size_t t = 0; t < slots_.size(); ++t) write(t);
+    while (!open_.empty()) {
+      close(open_.back());
+      open_.pop_back();
+    }
+    slots_.clear();
+    free_.clear();
+  }
+
+ private:
+  struct Slot {
+    std::unique_ptr<char[]> block;
+    std::size_t used = 0;
+    std::FILE* file = nullptr;
+    std::uint64_t last_write = 0;
+  };
+
+  std::unique_ptr<char[]> acquire() {
+    if (free_.empty() && allocated_ >= max_blocks_) evict();
+    if (!free_.empty()) {
+      std::unique_ptr<char[]> block = std::move(free_.back());
+      free_.pop_back();
+      return block;
+    }
+    ++allocated_;
+    return std::unique_ptr<char[]>(new char[kSpillBufferBytes]);
+  }
+
+  void evict() {
+    std::vector<std::size_t> holders;
+    for (std::size_t t = 0; t < slots_.size(); ++t) {
+      if (slots_[t].block) holders.push_back(t);
+    }
+    const std::size_t count = std::max<std::size_t>(1, holders.size() / 4);
+    std::nth_element(holders.begin(), holders.begin() + static_cast<std::ptrdiff_t>(count - 1), holders.end(),
+                     [this](std::size_t a, std::size_t b) { return slots_[a].used > slots_[b].used; });
+    for (std::size_t k = 0; k < count; ++k) {
+      write(holders[k]);
+      free_.push_back(std::move(slots_[holders[k]].block));
+    }
+  }
+
+  void write(std::size_t tile) {
+    Slot& slot = slots_[tile];
+    if (slot.used == 0) {
+      return;
+    }
+    if (std::fwrite(slot.block.get(), 1, slot.used, file(tile)) != slot.used) {
+      throw std::runtime_error("Failed to write tile file: " + tiles_[tile].raw_path);
+    }
+    slot.used = 0;
+  }
+
+  std::FILE* file(std::size_t tile) {
+    Slot& slot = slots_[tile];
+    slot.last_write = ++clock_;
+    if (slot.file) {
+      return slot.file;
+    }
+    if (open_.size() >= kMaxOpenFiles) {
+      const auto lru = std::min_element(open_.begin(), open_.end(), [this](std::size_t a, std::size_t b) {
+        return slots_[a].last_write < slots_[b].last_write;
+      });
+      const std::size_t victim = *lru;
+      *lru = open_.back();
+      open_.pop_back();
+      close(victim);
+    }
+    slot.file = std::fopen(tiles_[tile].raw_path.c_str(), "ab");
+    if (!slot.file) {
+      throw std::runtime_error("Failed to open tile file: " + tiles_[tile].raw_path);
+    }
+    open_.push_back(tile);
+    return slot.file;
+  }
+
+  void close(std::size_t tile) {
+    std::FILE* f = slots_[tile].file;
+    slots_[tile].file = nullptr;
+    if (std::fclose(f) != 0) {
+      throw std::runtime_error("Failed to write tile file: " + tiles_[tile].raw_path);
+    }
+  }
+
+  const std::vector<Tile>& tiles_;
+  std::size_t max_blocks_;
+  std::size_t allocated_ = 0;
+  std::uint64_t clock_ = 0;
+  std::vector<Slot> slots_;  // Per tile.
+  std::vector<std::unique_ptr<char[]>> free_;
+  std::vector<std::size_t> open_;  // Tiles whose file is open.
+};
+
+template <typename Record>
+std::vector<Record> readRecords(const std::string& path) {
+  std::vector<Record> records;
+  std::FILE* f = std::fopen(path.c_str(), "rb");
+  if (!f) {
+    return records;  // tile without records of this kind
+  }
+  std::fseek(f, 0, SEEK_END);
+  const long bytes = std::ftell(f);
+  std::fseek(f, 0, SEEK_SET);
+  records.resize(static_cast<std::size_t>(bytes) / sizeof(Record));
+  const std::size_t got = std::fread(records.data(), sizeof(Record), records.size(), f);
+  std::fclose(f);
+  if (got != records.size()) {
+    throw std::runtime_error("Failed to read tile file: " + path);
+  }
+  return records;
+}
+
+// Removes the spill directory unless asked to keep it.
+struct WorkDir {
+  std::filesystem::path path;
+  bool keep = false;
+
+  ~WorkDir() {
+    if (!keep && !path.empty()) {
+      std::error_code ec;
+      std::filesystem::remove_all(path, ec);
+    }
+  }
+};
+
+void mergeStats(ClusterStats& into, const ClusterStats& from) {
+  if (from.count == 0) {
+    return;
+  }
+  const float total = static_cast<float>(into.count + from.count);
+  into.centroid = (into.centroid * static_cast<float>(into.count) + from.centroid * static_cast<float>(from.count)) / total;
+  into.count += from.count;
+  into.min = into.min.cwiseMin(from.min);
+  into.max = into.max.cwiseMax(from.max);
+  into.nearest = std::min(into.nearest, from.nearest);
+}
+
+int findRoot(std::vector<int>& parent, int v) {
+  while (parent[v] != v) {
+    parent[v] = parent[parent[v]];
+    v = parent[v];
+  }
+  return v;
+}
+
+// Voxelize and label one tile; writes its labeled records and returns component summaries plus
+// the points within eps of the tile border.
+TileSummary processTile(Tile& tile, std::uint32_t tile_index, float tile_size, const Pose& pose, const Params& params) {
+  M2C_TRACE_SCOPE("tile.label");
+  const float eps = std::max(params.eps, 1e-6f);
+  std::vector<RawRecord> raw = readRecords<RawRecord>(tile.raw_path);
+  std::remove(tile.raw_path.c_str());
+
+  CloudT cloud;
+  cloud.reserve(raw.size());
+  for (const RawRecord& r : raw) {
+    cloud.push_back(PointT(r.x, r.y, r.z));
+  }
+  std::vector<std::uint64_t> ids(raw.size());
+  for (std::size_t i = 0; i < raw.size(); ++i) ids[i] = raw[i].id;
+  raw.clear();
+  raw.shrink_to_fit();
+
+  if (params.voxel > 0.0f) {
+    // Records arrive in file order, so the first source point of a voxel has its smallest id.
+    std::vector<int> first;
+    CloudT::Ptr filtered = voxelDownsample(cloud, params.voxel, &first);
+    std::vector<std::uint64_t> voxel_ids(first.size());
+    for (std::size_t i = 0; i < first.size(); ++i) voxel_ids[i] = ids[static_cast<std::size_t>(first[i])];
+    cloud = std::move(*filtered);
+    ids = std::move(voxel_ids);
+  }
+
+  TileSummary summary;
+  if (cloud.empty()) {
+    return summary;
+  }
+
+  IncrementalClusterer labeling(eps);
+  labeling.append(cloud);
+  const std::vector<PointIndices> clusters = labeling.clusters();
+  std::vector<int> labels;
+  summary.stats = labelClusters(labeling.cloud(), clusters, pose.C, labels);
+
+  const float x0 = static_cast<float>(tile.tx) * tile_size;
+  const float y0 = static_cast<float>(tile.ty) * tile_size;
+  std::vector<LabeledRecord> labeled(cloud.size());
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    const PointT& p = cloud[i];
+    labeled[i] = LabeledRecord{p.x, p.y, p.z, ids[i], labels[i]};
+    const bool near_border = p.x - x0 <= eps || x0 + tile_size - p.x <= eps || p.y - y0 <= eps ||
+                             y0 + tile_size - p.y <= eps;
+    if (near_border) {
+      summary.seam.push_back(SeamPoint{p.x, p.y, p.z, tile_index, labels[i]});
+    }
+  }
+  writeFile(tile.labeled_path, reinterpret_cast<const char*>(labeled.data()), labeled.size() * sizeof(LabeledRecord));
+  return summary;
+}
+
+// 2D distance from C to the XY footprint of a tile (z is unbounded inside a tile).
+float tileDistance(const Tile& tile, float tile_size, const Eigen::Vector3f& C) {
+  const float x0 = static_cast<float>(tile.tx) * tile_size;
+  const float y0 = static_cast<float>(tile.ty) * tile_size;
+  const float dx = std::max({x0 - C.x(), 0.0f, C.x() - (x0 + tile_size)});
+  const float dy = std::max({y0 - C.y(), 0.0f, C.y() - (y0 + tile_size)});
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+}  // namespace
+
+TiledSelection selectClusterTiled(const std::string& path,
+                                  const Pose& pose,
+                                  const Params& params,
+                                  const TiledOptions& options) {
+  M2C_TRACE_SCOPE("selectClusterTiled");
+  if (params.eps_auto) {
+    throw std::invalid_argument("Tiled selection needs an explicit eps; estimate it on a representative crop first");
+  }
+  TiledSelection out;
+  out.points.reset(new CloudT);
+
+  const float eps = std::max(params.eps, 1e-6f);
+  float tile_size = std::max(options.tile_size, 4.0f * eps);
+  if (params.voxel > 0.0f) {
+    tile_size = std::ceil(tile_size / params.voxel) * params.voxel;  // keep voxels inside one tile
+  }
+  const float inv_tile = 1.0f / tile_size;
+
+  static std::atomic<int> run_counter{0};
+  WorkDir work;
+  work.keep = options.keep_work_dir;
+  work.path = std::filesystem::path(options.work_dir.empty() ? std::filesystem::temp_directory_path().string()
+                                                             : options.work_dir) /
+              ("m2c_tiles_" + std::to_string(::getpid()) + "_" + std::to_string(run_counter++));
+  std::filesystem::create_directories(work.path);
+
+  // 1) Spill: stream the input into per-tile record files.
+  std::vector<Tile> tiles;
+  std::unordered_map<std::uint64_t, std::size_t> tile_of;
+  std::uint64_t next_id = 0;
+  // Points outside the camera frustum are never spilled; ids stay input order.
+  std::optional<Frustum> frustum;
+  if (params.frustum) {
+    frustum.emplace(pose, params);
+  }
+  std::vector<std::uint8_t> in_view;
+  {
+    M2C_TRACE_SCOPE("tile.spill");
+    // Nothing else is resident yet, so the spill buffers may use the whole memory budget.
+    SpillWriter spill(tiles, options.memory_budget);
+    forEachPointChunk(path, options.chunk_points, [&](const CloudT& chunk) {
+      if (frustum) {
+        frustum->contains(chunk, in_view);
+      }
+      for (std::size_t i = 0; i < chunk.size(); ++i) {
+        const PointT& p = chunk[i];
+        const std::uint64_t id = next_id++;
+        if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z) || (frustum && !in_view[i])) {
+          continue;
+        }
+        const auto tx = static_cast<std::int32_t>(std::floor(p.x * inv_tile));
+        const auto ty = static_cast<std::int32_t>(std::floor(p.y * inv_tile));
+        const auto inserted = tile_of.emplace(tileKey(tx, ty), tiles.size());
+        if (inserted.second) {
+          Tile tile;
+          tile.tx = tx;
+          tile.ty = ty;
+          const std::string stem = (work.path / ("tile_" + std::to_string(tiles.size()))).string();
+          tile.raw_path = stem + ".raw";
+          tile.labeled_path = stem + ".lbl";
+          tiles.push_back(std::move(tile));
+        }
+        const std::size_t t = inserted.first->second;
+        spill.add(t, RawRecord{p.x, p.y, p.z, id});
+        ++tiles[t].count;
+      }
+    });
+    spill.finish();
+  }
+  out.tiles = tiles.size();
+  if (tiles.empty()) {
+    return out;
+  }
+
+  // 2) Label tiles in parallel; a tile starts only when its working set fits the memory budget
+  //    (an oversized tile runs alone).
+  std::vector<TileSummary> summaries(tiles.size());
+  {
+    M2C_TRACE_SCOPE("tile.labelAll");
+    std::vector<std::size_t> order(tiles.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&tiles](std::size_t a, std::size_t b) { return tiles[a].count > tiles[b].count; });
+
+    std::mutex mutex;
+    std::condition_variable released;
+    std::size_t in_use = 0;
+    std::size_t next = 0;
+    std::exception_ptr failure;
+
+    const int hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const int workers = std::max(1, std::min<int>(options.threads > 0 ? options.threads : hw, static_cast<int>(tiles.size())));
+    std::vector<std::thread> pool;
+    for (int w = 0; w < workers; ++w) {
+      pool.emplace_back([&]() {
+        for (;;) {
+          std::size_t t = 0;
+          std::size_t cost = 0;
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (next >= order.size() || failure) return;
+            t = order[next++];
+            cost = static_cast<std::size_t>(tiles[t].count) * kBytesPerTilePoint;
+            released.wait(lock, [&]() { return in_use == 0 || in_use + cost <= options.memory_budget; });
+            in_use += cost;
+          }
+          try {
+            summaries[t] = processTile(tiles[t], static_cast<std::uint32_t>(t), tile_size, pose, params);
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!failure) failure = std::current_exception();
+          }
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            in_use -= cost;
+          }
+          released.notify_all();
+        }
+      });
+    }
+    for (std::thread& worker : pool) worker.join();
+    if (failure) std::rethrow_exception(failure);
+  }
+
+  // 3) Stitch: union tile-local components that touch across a seam.
+  std::vector<std::size_t> base(tiles.size() + 1, 0);
+  for (std::size_t t = 0; t < tiles.size(); ++t) base[t + 1] = base[t] + summaries[t].stats.size();
+  const std::size_t local_total = base.back();
+  std::vector<int> parent(local_total);
+  std::iota(parent.begin(), parent.end(), 0);
+  {
+    M2C_TRACE_SCOPE("tile.stitch");
+    const float inv_eps = 1.0f / eps;
+    const float eps_sq = eps * eps;
+    std::unordered_map<VoxelKey, std::vector<const SeamPoint*>, VoxelKeyHash> grid;
+    VoxelFrame frame{};
+    bool framed = false;
+    for (const TileSummary& summary : summaries) {
+      for (const SeamPoint& s : summary.seam) {
+        const PointT p(s.x, s.y, s.z);
+        if (!framed) {
+          frame = voxelFrame(p, inv_eps);
+          framed = true;
+        }
+        const VoxelKey key = voxelKeyOf(p, frame);
+        for (int dz = -1; dz <= 1; ++dz) {
+          for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+              const auto it = grid.find(VoxelKey{key.x + dx, key.y + dy, key.z + dz});
+              if (it == grid.end()) continue;
+              for (const SeamPoint* q : it->second) {
+                if (q->tile == s.tile) continue;
+                const float ex = s.x - q->x;
+                const float ey = s.y - q->y;
+                const float ez = s.z - q->z;
+                if (ex * ex + ey * ey + ez * ez > eps_sq) continue;
+                const int a = findRoot(parent, static_cast<int>(base[s.tile] + static_cast<std::size_t>(s.comp)));
+                const int b = findRoot(parent, static_cast<int>(base[q->tile] + static_cast<std::size_t>(q->comp)));
+                if (a != b) parent[std::max(a, b)] = std::min(a, b);
+              }
+            }
+          }
+        }
+        grid[key].push_back(&s);
+      }
+    }
+  }
+
+  // Global components: merged summaries plus the tiles each one spans.
+  std::vector<int> global_of(local_total, -1);
+  std::vector<std::vector<std::uint32_t>> tiles_of;
+  Result& result = out.result;
+  result.eps = params.eps;
+  for (std::size_t t = 0; t < tiles.size(); ++t) {
+    for (std::size_t c = 0; c < summaries[t].stats.size(); ++c) {
+      const std::size_t local = base[t] + c;
+      const int root = findRoot(parent, static_cast<int>(local));
+      if (global_of[static_cast<std::size_t>(root)] < 0) {
+        global_of[static_cast<std::size_t>(root)] = static_cast<int>(result.stats.size());
+        result.stats.emplace_back();
+        tiles_of.emplace_back();
+      }
+      const int g = global_of[static_cast<std::size_t>(root)];
+      global_of[local] = g;
+      mergeStats(result.stats[static_cast<std::size_t>(g)], summaries[t].stats[c]);
+      if (tiles_of[static_cast<std::size_t>(g)].empty() || tiles_of[static_cast<std::size_t>(g)].back() != t) {
+        tiles_of[static_cast<std::size_t>(g)].push_back(static_cast<std::uint32_t>(t));
+      }
+    }
+  }
+  if (result.stats.empty()) {
+    return out;
+  }
+
+  // 4) Size filter and top-m vote, touching only tiles that can hold one of the m nearest points.
+  std::size_t total_points = 0;
+  for (const ClusterStats& cs : result.stats) total_points += static_cast<std::size_t>(cs.count);
+  const double mean = static_cast<double>(total_points) / static_cast<double>(result.stats.size());
+  result.min_keep = std::max(1, static_cast<int>(std::floor(params.n * mean)));
+
+  std::vector<int> kept;
+  for (std::size_t g = 0; g < result.stats.size(); ++g) {
+    if (result.stats[g].count >= result.min_keep) kept.push_back(static_cast<int>(g));
+  }
+  if (kept.empty()) {
+    return out;
+  }
+  std::sort(kept.begin(), kept.end(), [&result](int a, int b) { return result.stats[a].nearest < result.stats[b].nearest; });
+  const std::size_t want = static_cast<std::size_t>(std::max(1, params.m));
+  float reach = 0.0f;
+  std::size_t covered = 0;
+  for (int g : kept) {
+    reach = std::max(reach, result.stats[static_cast<std::size_t>(g)].farthestBound(pose.C));
+    covered += static_cast<std::size_t>(result.stats[static_cast<std::size_t>(g)].count);
+    if (covered >= want) break;
+  }
+
+  struct NearRec { float dist; int g; };
+  std::vector<NearRec> pool;
+  {
+    M2C_TRACE_SCOPE("tile.vote");
+    for (std::size_t t = 0; t < tiles.size(); ++t) {
+      if (tileDistance(tiles[t], tile_size, pose.C) > reach) continue;
+      ++out.tiles_voted;
+      for (const LabeledRecord& r : readRecords<LabeledRecord>(tiles[t].labeled_path)) {
+        const int g = global_of[base[t] + static_cast<std::size_t>(r.comp)];
+        if (result.stats[static_cast<std::size_t>(g)].count < result.min_keep) continue;
+        const float dist = (Eigen::Vector3f(r.x, r.y, r.z) - pose.C).norm();
+        if (dist <= reach) pool.push_back({dist, g});
+      }
+    }
+  }
+  if (pool.empty()) {
+    return out;
+  }
+  const std::size_t take = std::min(want, pool.size());
+  std::nth_element(pool.begin(), pool.begin() + take, pool.end(), [](const NearRec& a, const NearRec& b) { return a.dist < b.dist; });
+  pool.resize(take);
+
+  std::unordered_map<int, std::pair<int, double>> tally;  // g -> (count, sum of distances)
+  for (const NearRec& rec : pool) {
+    auto& entry = tally[rec.g];
+    entry.first += 1;
+    entry.second += rec.dist;
+  }
+  int best = -1;
+  int best_count = -1;
+  double best_sum = std::numeric_limits<double>::infinity();
+  for (const auto& entry : tally) {
+    const int count = entry.second.first;
+    const double sum = entry.second.second;
+    // Same order as selectCluster's vote: count, then distance sum, then the lowest cluster id
+    if (count > best_count || (count == best_count && sum < best_sum) ||
+        (count == best_count && sum == best_sum && entry.first < best)) {
+      best = entry.first;
+      best_count = count;
+      best_sum = sum;
+    }
+  }
+
+  result.cluster_id = best;
+  if (!Validator{params.minPts_total, params.maxDiameter}.pass(result.stats[static_cast<std::size_t>(best)])) {
+    result.rejected = true;  // too small or too large; there is no seeded fallback out of core
+    return out;
+  }
+
+  // Gather the winner from the tiles it spans.
+  for (std::uint32_t t : tiles_of[static_cast<std::size_t>(best)]) {
+    for (const LabeledRecord& r : readRecords<LabeledRecord>(tiles[t].labeled_path)) {
+      if (global_of[base[t] + static_cast<std::size_t>(r.comp)] != best) continue;
+      result.cluster.indices.push_back(static_cast<int>(out.points->size()));
+      out.points->push_back(PointT(r.x, r.y, r.z));
+      out.ids.push_back(r.id);
+    }
+  }
+  out.points->width = static_cast<std::uint32_t>(out.points->size());
+  out.points->height = 1;
+  out.points->is_dense = false;
+
+  result.found = true;
+  result.trials = 1;
+  result.cluster.diameter = result.stats[static_cast<std::size_t>(best)].diameter();
+  return out;
+}
+
+}  // namespace m2c
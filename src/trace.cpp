@@ -0,0 +1,161 @@
+#include "m2c/trace.h"
+
+#ifdef M2C_ENABLE_TRACE
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#endif
+
+#include <stdexcept>
+
+namespace m2c {
+namespace trace {
+
+#ifdef M2C_ENABLE_TRACE
+namespace {
+
+constexpr std::size_t kRingCapacity = 1u << 16;  // spans kept per thread
+
+struct Event {
+  const char* name;
+  std::int64_t begin_ns;
+  std::int64_t end_ns;
+};
+
+// Written only by its owning thread; `head` is published with release so the exporter can read
+// completed slots from another thread.
+struct Ring {
+  int tid = 0;
+  std::atomic<std::uint64_t> head{0};
+  std::array<Event, kRingCapacity> events;
+};
+
+std::atomic<bool> g_active{false};
+std::chrono::steady_clock::time_point g_origin;
+std::mutex g_registry_mutex;                  // taken once per thread, at registration
+std::vector<std::unique_ptr<Ring>> g_rings;   // rings outlive their threads
+
+std::int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_origin).count();
+}
+
+Ring& localRing() {
+  thread_local Ring* ring = nullptr;
+  if (!ring) {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    g_rings.push_back(std::make_unique<Ring>());
+    ring = g_rings.back().get();
+    ring->tid = static_cast<int>(g_rings.size());
+  }
+  return *ring;
+}
+
+}  // namespace
+
+void start() {
+  g_origin = std::chrono::steady_clock::now();
+  g_active.store(true, std::memory_order_release);
+}
+
+bool active() {
+  return g_active.load(std::memory_order_relaxed);
+}
+
+Scope::Scope(const char* name) : name_(name), begin_ns_(-1) {
+  if (active()) {
+    begin_ns_ = nowNs();
+  }
+}
+
+Scope::~Scope() {
+  if (begin_ns_ < 0 || !active()) {
+    return;
+  }
+  Ring& ring = localRing();
+  const std::uint64_t slot = ring.head.load(std::memory_order_relaxed);
+  ring.events[slot % kRingCapacity] = Event{name_, begin_ns_, nowNs()};
+  ring.head.store(slot + 1, std::memory_order_release);
+}
+
+void writeChromeTrace(const std::string& path) {
+  g_active.store(false, std::memory_order_seq_cst);
+
+  // Copy every ring before formatting, so a still-running writer overlaps only the short copy.
+  struct Snapshot {
+    int tid;
+    std::vector<Event> events;
+  };
+  std::vector<Snapshot> snapshots;
+  {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    snapshots.reserve(g_rings.size());
+    for (const auto& ring : g_rings) {
+      const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+      const std::uint64_t first = head > kRingCapacity ? head - kRingCapacity : 0;
+      Snapshot snapshot{ring->tid, {}};
+      snapshot.events.reserve(static_cast<std::size_t>(head - first));
+      for (std::uint64_t i = first; i < head; ++i) {
+        snapshot.events.push_back(ring->events[i % kRingCapacity]);
+      }
+      // A writer that passed its active() check before the stop may have wrapped onto the oldest
+      // slots meanwhile (including the one it is still filling); drop those.
+      const std::uint64_t after = ring->head.load(std::memory_order_acquire);
+      const std::uint64_t reused = after + 1 > kRingCapacity ? after + 1 - kRingCapacity : 0;
+      if (reused > first) {
+        const std::size_t drop = static_cast<std::size_t>(std::min(reused - first, head - first));
+        snapshot.events.erase(snapshot.events.begin(), snapshot.events.begin() + static_cast<std::ptrdiff_t>(drop));
+      }
+      snapshots.push_back(std::move(snapshot));
+    }
+  }
+
+  std::FILE* out = std::fopen(path.c_str(), "w");
+  if (!out) {
+    throw std::runtime_error("Failed to open trace file for writing: " + path);
+  }
+
+  std::fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  std::fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"mask2cluster\"}}");
+
+  for (const Snapshot& snapshot : snapshots) {
+    std::fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+                 snapshot.tid, snapshot.tid);
+    for (const Event& e : snapshot.events) {
+      std::fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"m2c\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                   e.name, snapshot.tid, static_cast<double>(e.begin_ns) / 1000.0,
+                   static_cast<double>(std::max<std::int64_t>(0, e.end_ns - e.begin_ns)) / 1000.0);
+    }
+  }
+  std::fprintf(out, "\n]}\n");
+
+  if (std::fclose(out) != 0) {
+    throw std::runtime_error("Failed to write trace file: " + path);
+  }
+}
+
+#else
+
+void start() {}
+
+bool active() {
+  return false;
+}
+
+Scope::Scope(const char* name) : name_(name), begin_ns_(-1) {}
+
+Scope::~Scope() {}
+
+void writeChromeTrace(const std::string& path) {
+  throw std::runtime_error("Tracing was not compiled in (reconfigure with M2C_WITH_TRACE=ON); cannot write " + path);
+}
+
+#endif
+
+}  // namespace trace
+}  // namespace m2c
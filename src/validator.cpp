@@ -3,7 +3,7 @@
 namespace m2c {
 
 bool Validator::pass(const Cluster& cluster) const {
-  if (minPtsTotal <= 0) {
+  if (minPtsTotal <= 0 || cluster.truncated) {
     return false;
   }
   if (static_cast<int>(cluster.indices.size()) < minPtsTotal) {
@@ -23,4 +23,17 @@ bool Validator::sureNoise(const Cluster& cluster) const {
   return static_cast<float>(cluster.indices.size()) < threshold;
 }
 
+bool Validator::pass(const ClusterStats& stats) const {
+  if (minPtsTotal <= 0) {
+    return false;
+  }
+  if (stats.count < minPtsTotal) {
+    return false;
+  }
+  if (maxDiameter > 0.0f && stats.diameter() > maxDiameter) {
+    return false;
+  }
+  return true;
+}
+
 }  // namespace m2c
@@ -0,0 +1,171 @@
+#include "m2c/voxel_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef M2C_CORE_ONLY
+#include <pcl/filters/voxel_grid.h>
+#endif
+
+#include "m2c/trace.h"
+#include "m2c/voxel_key.h"
+
+namespace m2c {
+
+CloudT::Ptr voxelDownsample(const CloudT& cloud, float leaf, std::vector<int>* first_source,
+                            std::vector<int>* voxel_of, const std::function<void()>& poll) {
+  M2C_TRACE_SCOPE("voxelDownsample");
+  if (!(leaf > 0.0f)) {
+    throw std::invalid_argument("Voxel downsampling requires a positive leaf size");
+  }
+
+  struct Sum {
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+    int count = 0;
+    int first = -1;
+  };
+
+  const float inv = 1.0f / leaf;
+  VoxelFrame frame{};
+  std::unordered_map<VoxelKey, int, VoxelKeyHash> slot_of;
+  slot_of.reserve(cloud.size() / 4 + 1);
+  std::vector<Sum> sums;
+  if (voxel_of) voxel_of->assign(cloud.size(), -1);
+
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    if (poll && (i & 4095u) == 0) {
+      poll();
+    }
+    const PointT& p = cloud[i];
+    if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) {
+      continue;
+    }
+    if (sums.empty()) frame = voxelFrame(p, inv);  // Keys count cells from the first finite point.
+    const auto inserted = slot_of.emplace(voxelKeyOf(p, frame), static_cast<int>(sums.size()));
+    if (inserted.second) {
+      sums.emplace_back();
+      sums.back().first = static_cast<int>(i);
+    }
+    if (voxel_of) (*voxel_of)[i] = inserted.first->second;  // output order is slot order
+    Sum& s = sums[static_cast<std::size_t>(inserted.first->second)];
+    s.x += p.x;
+    s.y += p.y;
+    s.z += p.z;
+    ++s.count;
+  }
+
+  CloudT::Ptr out(new CloudT);
+  out->reserve(sums.size());
+  if (first_source) {
+    first_source->clear();
+    first_source->reserve(sums.size());
+  }
+  for (const Sum& s : sums) {
+    const double inv_count = 1.0 / static_cast<double>(s.count);
+    out->push_back(PointT(static_cast<float>(s.x * inv_count), static_cast<float>(s.y * inv_count),
+                          static_cast<float>(s.z * inv_count)));
+    if (first_source) first_source->push_back(s.first);
+  }
+  out->width = static_cast<std::uint32_t>(out->size());
+  out->height = 1;
+  out->is_dense = false;
+  return out;
+}
+
+VoxelAccumulator::VoxelAccumulator(float leaf) : frame_{} {
+  if (!(leaf > 0.0f)) {
+    throw std::invalid_argument("Voxel downsampling requires a positive leaf size");
+  }
+  frame_.inv_cell = 1.0f / leaf;
+}
+
+void VoxelAccumulator::add(const CloudT& chunk, const PointAttributes* attributes) {
+  M2C_TRACE_SCOPE("voxelAccumulate");
+  if (slot_of_.empty()) {
+    slot_of_.reserve(chunk.size() / 4 + 1);
+  }
+  fresh_.clear();
+  for (std::size_t i = 0; i < chunk.size(); ++i) {
+    const PointT& p = chunk[i];
+    if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) {
+      continue;
+    }
+    if (sums_.empty()) frame_ = voxelFrame(p, frame_.inv_cell);
+    const VoxelKey key = voxelKeyOf(p, frame_);
+    const auto inserted = slot_of_.emplace(key, static_cast<int>(sums_.size()));
+    if (inserted.second) {
+      sums_.emplace_back();
+      sums_.back().first = static_cast<int>(seen_ + i);
+      keys_.push_back(key);
+      fresh_.push_back(static_cast<int>(i));
+    }
+    Sum& s = sums_[static_cast<std::size_t>(inserted.first->second)];
+    s.x += p.x;
+    s.y += p.y;
+    s.z += p.z;
+    ++s.count;
+  }
+  if (attributes && !attributes->empty()) {
+    first_attributes_.append(attributes->select(fresh_));
+  }
+  seen_ += chunk.size();
+}
+
+CloudT::Ptr VoxelAccumulator::finish(std::vector<int>* first_source, PointAttributes* attributes) const {
+  // pcl::VoxelGrid emits voxels by ascending linear index, i.e. ordered by (z, y, x) cell; keep
+  // that order so FEC sees the same sequence in both builds.
+  std::vector<int> order(sums_.size());
+  for (std::size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+  std::sort(order.begin(), order.end(), [this](int a, int b) {
+    const VoxelKey& ka = keys_[static_cast<std::size_t>(a)];
+    const VoxelKey& kb = keys_[static_cast<std::size_t>(b)];
+    return ka.z != kb.z ? ka.z < kb.z : ka.y != kb.y ? ka.y < kb.y : ka.x < kb.x;
+  });
+
+  CloudT::Ptr out(new CloudT);
+  out->reserve(order.size());
+  if (first_source) {
+    first_source->clear();
+    first_source->reserve(order.size());
+  }
+  for (int slot : order) {
+    const Sum& s = sums_[static_cast<std::size_t>(slot)];
+    const double inv_count = 1.0 / static_cast<double>(s.count);
+    out->push_back(PointT(static_cast<float>(s.x * inv_count), static_cast<float>(s.y * inv_count),
+                          static_cast<float>(s.z * inv_count)));
+    if (first_source) first_source->push_back(s.first);
+  }
+  if (attributes) {
+    *attributes = first_attributes_.select(order);
+  }
+  out->width = static_cast<std::uint32_t>(out->size());
+  out->height = 1;
+  out->is_dense = false;
+  return out;
+}
+
+CloudT::Ptr voxelFilter(const CloudT::Ptr& cloud, float leaf, std::vector<int>* first_source) {
+  M2C_TRACE_SCOPE("voxelize");
+#ifndef M2C_CORE_ONLY
+  if (!first_source) {
+    CloudT::Ptr filtered(new CloudT);
+    pcl::VoxelGrid<PointT> voxel;
+    voxel.setInputCloud(cloud);
+    voxel.setLeafSize(leaf, leaf, leaf);
+    voxel.filter(*filtered);
+    return filtered;
+  }
+#endif
+  VoxelAccumulator voxels(leaf);
+  voxels.add(*cloud);
+  return voxels.finish(first_source);
+}
+
+}  // namespace m2c
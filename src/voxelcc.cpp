@@ -0,0 +1,124 @@
+#include "m2c/voxelcc.h"
+
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "m2c/trace.h"
+#include "m2c/voxel_key.h"
+
+namespace m2c {
+namespace {
+
+int findRoot(std::vector<int>& parent, int v) {
+  while (parent[v] != v) {
+    parent[v] = parent[parent[v]];
+    v = parent[v];
+  }
+  return v;
+}
+
+void unite(std::vector<int>& parent, int a, int b) {
+  a = findRoot(parent, a);
+  b = findRoot(parent, b);
+  if (a == b) {
+    return;
+  }
+  // Keep the smaller voxel id as root so component order follows first appearance.
+  if (a < b) {
+    parent[b] = a;
+  } else {
+    parent[a] = b;
+  }
+}
+
+}  // namespace
+
+std::vector<PointIndices> voxelConnectedComponents(const CloudT& cloud,
+                                                        float cell,
+                                                        const std::function<void()>& poll) {
+  M2C_TRACE_SCOPE("voxelcc");
+  std::vector<PointIndices> clusters;
+  if (cloud.empty()) {
+    return clusters;
+  }
+  if (!(cell > 0.0f)) {
+    throw std::invalid_argument("Voxel connectivity requires a positive cell size");
+  }
+
+  const float inv = 1.0f / cell;
+  VoxelFrame frame{};
+  std::unordered_map<VoxelKey, int, VoxelKeyHash> voxel_ids;
+  voxel_ids.reserve(cloud.size());
+  std::vector<VoxelKey> voxels;
+  std::vector<int> point_voxel(cloud.size(), -1);
+
+  // 1) Bucket points into occupied voxels (ids follow first appearance).
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    if (poll && (i & 4095u) == 0) {
+      poll();
+    }
+    const PointT& p = cloud[i];
+    if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) {
+      continue;
+    }
+    if (voxels.empty()) frame = voxelFrame(p, inv);  // Keys count cells from the first finite point.
+    const VoxelKey key = voxelKeyOf(p, frame);
+    const auto inserted = voxel_ids.emplace(key, static_cast<int>(voxels.size()));
+    if (inserted.second) {
+      voxels.push_back(key);
+    }
+    point_voxel[i] = inserted.first->second;
+  }
+
+  // 2) Union each voxel with its 26-neighborhood. Visiting half of the offsets suffices
+  //    because adjacency is symmetric.
+  std::vector<int> parent(voxels.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  for (std::size_t v = 0; v < voxels.size(); ++v) {
+    if (poll && (v & 1023u) == 0) {
+      poll();
+    }
+    const VoxelKey& k = voxels[v];
+    for (int dz = -1; dz <= 1; ++dz) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+          const bool forward = dz > 0 || (dz == 0 && (dy > 0 || (dy == 0 && dx > 0)));
+          if (!forward) {
+            continue;
+          }
+          const auto it = voxel_ids.find(VoxelKey{k.x + dx, k.y + dy, k.z + dz});
+          if (it != voxel_ids.end()) {
+            unite(parent, static_cast<int>(v), it->second);
+          }
+        }
+      }
+    }
+  }
+
+  // 3) Compact roots into dense component ids and scatter point indices.
+  std::vector<int> component_of_root(voxels.size(), -1);
+  std::vector<int> voxel_component(voxels.size());
+  for (std::size_t v = 0; v < voxels.size(); ++v) {
+    const int root = findRoot(parent, static_cast<int>(v));
+    if (component_of_root[root] < 0) {
+      component_of_root[root] = static_cast<int>(clusters.size());
+      clusters.emplace_back();
+    }
+    voxel_component[v] = component_of_root[root];
+  }
+
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    if (point_voxel[i] < 0) {
+      continue;
+    }
+    clusters[static_cast<std::size_t>(voxel_component[point_voxel[i]])].indices.push_back(static_cast<int>(i));
+  }
+
+  return clusters;
+}
+
+}  // namespace m2c
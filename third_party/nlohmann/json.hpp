@@ -64,27 +64,34 @@ class json {
 	template <typename T>
 	T get() const {
 		static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value ||
-											std::is_same<T, int>::value,
-									"minimal json shim only supports float/double/int conversions");
-		if (type_ == value_t::number) {
-			if constexpr (std::is_same<T, float>::value) {
-				return static_cast<float>(number_);
-			} else if constexpr (std::is_same<T, double>::value) {
-				return number_;
-			} else {
-				return static_cast<int>(number_);
+											std::is_same<T, int>::value || std::is_same<T, string_t>::value,
+									"minimal json shim only supports float/double/int/string conversions");
+		if constexpr (std::is_same<T, string_t>::value) {
+			if (type_ == value_t::string) {
+				return string_;
 			}
-		}
-		if (type_ == value_t::boolean) {
-			if constexpr (std::is_same<T, float>::value) {
-				return boolean_ ? 1.0f : 0.0f;
-			} else if constexpr (std::is_same<T, double>::value) {
-				return boolean_ ? 1.0 : 0.0;
-			} else {
-				return boolean_ ? 1 : 0;
+			throw std::runtime_error("json::get conversion failed: incompatible type");
+		} else {
+			if (type_ == value_t::number) {
+				if constexpr (std::is_same<T, float>::value) {
+					return static_cast<float>(number_);
+				} else if constexpr (std::is_same<T, double>::value) {
+					return number_;
+				} else {
+					return static_cast<int>(number_);
+				}
+			}
+			if (type_ == value_t::boolean) {
+				if constexpr (std::is_same<T, float>::value) {
+					return boolean_ ? 1.0f : 0.0f;
+				} else if constexpr (std::is_same<T, double>::value) {
+					return boolean_ ? 1.0 : 0.0;
+				} else {
+					return boolean_ ? 1 : 0;
+				}
 			}
+			throw std::runtime_error("json::get conversion failed: incompatible type");
 		}
-		throw std::runtime_error("json::get conversion failed: incompatible type");
 	}
 
 	static json parse(std::istream& is) {
@@ -8,11 +8,10 @@
 #include <vector>
 #include <algorithm>
 #include <cstring>
+#include <functional>
 
-#include <pcl/point_types.h>
-#include <pcl/kdtree/kdtree_flann.h>
-#include <pcl/point_cloud.h>
-#include <pcl/PointIndices.h>
+#include "m2c/kdtree.h"
+#include "m2c/types.h"
 
 namespace pcg {
 
@@ -26,33 +25,34 @@ inline bool NumberTagLess(const PointIndex_NumberTag& p0, const PointIndex_Numbe
     return p0.nNumberTag < p1.nNumberTag;
 }
 
-// FEC clustering: radius-based fast equivalent class labeling
-inline std::vector<pcl::PointIndices> FEC(const pcl::PointCloud<pcl::PointXYZ>::Ptr& cloud,
-                                          int min_component_size,
-                                          double tolerance,
-                                          int max_n) {
+// FEC clustering over any neighbor search: `search.radius(idx, tolerance, out, max_n)` must follow
+// the m2c::KD::radius contract. Labels points [0, cloud_size).
+// `poll` (optional) is invoked every few hundred seeds and before each relabel sweep; it may
+// throw to cancel a long-running labeling cooperatively.
+template <typename Search>
+std::vector<m2c::PointIndices> FECWith(const Search& search,
+                                       std::size_t cloud_size,
+                                       int min_component_size,
+                                       double tolerance,
+                                       int max_n,
+                                       const std::function<void()>& poll = std::function<void()>()) {
     using std::size_t;
     size_t i, j;
-    const size_t cloud_size = cloud ? cloud->size() : 0;
-    std::vector<pcl::PointIndices> empty;
-    if (!cloud || cloud_size == 0) { return empty; }
-
-    pcl::KdTreeFLANN<pcl::PointXYZ> cloud_kdtreeflann;
-    cloud_kdtreeflann.setInputCloud(cloud);
+    std::vector<m2c::PointIndices> empty;
+    if (cloud_size == 0) { return empty; }
 
     std::vector<int> marked_indices(cloud_size, 0);
     std::vector<int> pointIdx;
-    std::vector<float> pointSquaredDistance;
 
     int tag_num = 1;
     int temp_tag_num = -1;
 
     for (i = 0; i < cloud_size; ++i) {
+        if (poll && (i & 255u) == 0) { poll(); }
         // Clustering process
         if (marked_indices[i] == 0) { // not yet labeled
             pointIdx.clear();
-            pointSquaredDistance.clear();
-            cloud_kdtreeflann.radiusSearch(cloud->points[i], tolerance, pointIdx, pointSquaredDistance, max_n);
+            search.radius(static_cast<int>(i), static_cast<float>(tolerance), pointIdx, max_n);
 
             int min_tag_num = tag_num;
             for (j = 0; j < pointIdx.size(); ++j) {
@@ -65,6 +65,7 @@ inline std::vector<pcl::PointIndices> FEC(const pcl::PointCloud<pcl::PointXYZ>::
             for (j = 0; j < pointIdx.size(); ++j) {
                 temp_tag_num = marked_indices[pointIdx[j]];
                 if (temp_tag_num > min_tag_num) {
+                    if (poll) { poll(); }
                     for (size_t k = 0; k < cloud_size; ++k) {
                         if (marked_indices[k] == temp_tag_num) {
                             marked_indices[k] = min_tag_num;
@@ -83,8 +84,8 @@ inline std::vector<pcl::PointIndices> FEC(const pcl::PointCloud<pcl::PointXYZ>::
     }
     std::sort(indices_tags.begin(), indices_tags.end(), NumberTagLess);
 
-    std::vector<pcl::PointIndices> cluster_indices;
-    pcl::PointIndices::Ptr inliers(new pcl::PointIndices);
+    std::vector<m2c::PointIndices> cluster_indices;
+    m2c::PointIndices::Ptr inliers(new m2c::PointIndices);
 
     size_t begin_index = 0;
     for (i = 0; i < indices_tags.size(); ++i) {
@@ -114,6 +115,24 @@ inline std::vector<pcl::PointIndices> FEC(const pcl::PointCloud<pcl::PointXYZ>::
     return cluster_indices;
 }
 
+// FEC clustering: radius-based fast equivalent class labeling
+// `poll` (optional) is invoked every few hundred seeds and before each relabel sweep; it may
+// throw to cancel a long-running labeling cooperatively.
+inline std::vector<m2c::PointIndices> FEC(const m2c::CloudT::Ptr& cloud,
+                                          int min_component_size,
+                                          double tolerance,
+                                          int max_n,
+                                          const std::function<void()>& poll = std::function<void()>()) {
+    const std::size_t cloud_size = cloud ? cloud->size() : 0;
+    if (cloud_size == 0) { return std::vector<m2c::PointIndices>(); }
+
+    // m2c::KD picks the tree or, for small/compact clouds, a brute-force scan with no build cost.
+    m2c::KDOptions kd_options;
+    kd_options.radius_hint = static_cast<float>(tolerance);
+    const m2c::KD cloud_kdtree(*cloud, kd_options);
+    return FECWith(cloud_kdtree, cloud_size, min_component_size, tolerance, max_n, poll);
+}
+
 } // namespace pcg
 
 #endif // PCG_SEGMENT_FEC_H